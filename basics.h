@@ -4,5 +4,8 @@
 #include "basics_base.h"
 #include "basics_bits.h"
 #include "basics_memory.h"
+#include "basics_string.h"
+#include "basics_table.h"
+#include "basics_vector.h"
 
 #endif
@@ -40,6 +40,9 @@
 #if defined(SYSTEM_IS_WIN64)
 #include <intrin.h>
 #endif
+#if defined(__clang__) || defined(__GNUC__)
+#include <cpuid.h>
+#endif
 #endif
 
 #if defined(LANGUAGE_IS_CPP)
@@ -62,20 +65,22 @@
 #define CCALL       __attribute__((cdecl))
 #define STDCALL     __attribute__((stdcall))
 #define FASTCALL    __attribute__((fastcall))
-#define PUBLIC      __attribute__((visibility("default"))) EXTERNAL
+#define PUBLIC      EXTERNAL __attribute__((visibility("default")))
 #define IMPORTED    EXTERNAL
 #define UNRETURNING __attribute__((noreturn)) void
 #define INLINED     __attribute__((always_inline))
 #define THREADIC    __thread
+#define TARGETED(s) __attribute__((target(s)))
 #elif defined(COMPILER_IS_MSC)
 #define CCALL       __cdecl
 #define STDCALL     __stdcall
 #define FASTCALL    __fastcall
-#define PUBLIC      __declspec(dllexport) EXTERNAL
-#define IMPORTED    __declspec(dllimport) EXTERNAL
+#define PUBLIC      EXTERNAL __declspec(dllexport)
+#define IMPORTED    EXTERNAL __declspec(dllimport)
 #define UNRETURNING __declspec(noreturn) void
 #define INLINED     __forceinline
 #define THREADIC    __declspec(thread)
+#define TARGETED(s)
 #endif
 
 #if defined(SYSTEM_IS_WIN64)
@@ -108,7 +113,11 @@
 
 #if defined(__clang__) || defined(__GNUC__)
 #define FallThrough() __attribute__((fallthrough))
+#if defined(__clang__)
 #define DebugTrap()   __builtin_debugtrap()
+#else
+#define DebugTrap()   __builtin_trap()
+#endif
 #define DontReach()   __bulitin_unreachable()
 
 typedef __builtin_va_list VArgs;
@@ -207,4 +216,140 @@ typedef signed int   Count;
 typedef long long Address;
 typedef long long Handle;
 
+/******************************************************************************/
+/* atomics */
+
+/* NOTE(Emhyr): these're only meant for 64-bit integers. the loads acquire, the
+stores release, and the rest do both */
+
+#if defined(COMPILER_IS_CLANG) || defined(COMPILER_IS_GNUC)
+#define AtomicLoad(p)                  __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define AtomicStore(p, x)              __atomic_store_n(p, x, __ATOMIC_RELEASE)
+#define AtomicExchange(p, x)           __atomic_exchange_n(p, x, __ATOMIC_ACQ_REL)
+#define AtomicFetchAdd(p, x)           __atomic_fetch_add(p, x, __ATOMIC_ACQ_REL)
+#define AtomicCompareExchange(p, e, x) __atomic_compare_exchange_n(p, e, x, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#elif defined(COMPILER_IS_MSC)
+#define AtomicLoad(p)                  (*(volatile long long *)(p))
+#define AtomicStore(p, x)              (void)_InterlockedExchange64((volatile long long *)(p), (long long)(x))
+#define AtomicExchange(p, x)           _InterlockedExchange64((volatile long long *)(p), (long long)(x))
+#define AtomicFetchAdd(p, x)           _InterlockedExchangeAdd64((volatile long long *)(p), (long long)(x))
+#define AtomicCompareExchange(p, e, x) DoAtomicCompareExchange((volatile long long *)(p), (long long *)(e), (long long)(x))
+INLINED int DoAtomicCompareExchange(volatile long long *p, long long *e, long long x) {
+	long long r = _InterlockedCompareExchange64(p, x, *e);
+	int result = r == *e;
+	*e = r;
+	return result;
+}
+#endif
+
+#if defined(ARCHITECTURE_IS_X64)
+#define Pause() _mm_pause()
+#elif defined(COMPILER_IS_CLANG) || defined(COMPILER_IS_GNUC)
+#define Pause() __asm__ volatile ("yield")
+#elif defined(COMPILER_IS_MSC)
+#define Pause() __yield()
+#endif
+
+#if defined(SYSTEM_IS_WIN64)
+EXTERNAL int __stdcall SwitchToThread(void);
+#define YieldThread() (void)SwitchToThread()
+#elif defined(SYSTEM_IS_UNIX)
+#include <sched.h>
+#define YieldThread() (void)sched_yield()
+#endif
+
+/* the pauses of a lock's waiter before it yields its processor to the holder */
+#if !defined(LOCK_SPINS_COUNT)
+#define LOCK_SPINS_COUNT 64
+#endif
+
+/* NOTE(Emhyr): a lock is a zeroed `Word` */
+
+PRIVATE inline void AcquireLock(volatile Word *lock) {
+	while (AtomicExchange(lock, 1)) {
+		for (Size spins = 0; AtomicLoad(lock); ++spins) {
+			if (spins < LOCK_SPINS_COUNT) Pause();
+			else YieldThread();
+		}
+	}
+}
+
+PRIVATE inline void ReleaseLock(volatile Word *lock) {
+	AtomicStore(lock, 0);
+}
+
+/******************************************************************************/
+
+/* processor features that are usable with both the processor's and the
+system's support. procedures that're `TARGETED` to these should only be called
+after checking them */
+
+#define PROCESSOR_FEATURE_POPCNT    0x01
+#define PROCESSOR_FEATURE_BMI1      0x02
+#define PROCESSOR_FEATURE_BMI2      0x04
+#define PROCESSOR_FEATURE_AVX2      0x08
+#define PROCESSOR_FEATURE_AVX512F   0x10
+#define PROCESSOR_FEATURE_AVX512BW  0x20
+#define PROCESSOR_FEATURE_AVX512VL  0x40
+#define PROCESSOR_FEATURE_AVX512POP 0x80 /* NOTE(Emhyr): AVX512_VPOPCNTDQ */
+
+#define PROCESSOR_FEATURES_AVX512 (PROCESSOR_FEATURE_AVX512F | PROCESSOR_FEATURE_AVX512BW | PROCESSOR_FEATURE_AVX512VL)
+
+#if defined(ARCHITECTURE_IS_X64)
+
+PRIVATE inline void QueryCpuid(U32 leaf, U32 subleaf, U32 registers[4]) {
+#if defined(COMPILER_IS_CLANG) || defined(COMPILER_IS_GNUC)
+	__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#elif defined(COMPILER_IS_MSC)
+	__cpuidex((int *)registers, leaf, subleaf);
+#endif
+}
+
+PRIVATE inline U64 QueryXcr0(void) {
+#if defined(COMPILER_IS_CLANG) || defined(COMPILER_IS_GNUC)
+	U32 low, high;
+	__asm__ volatile ("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+	return (U64)high << 32 | low;
+#elif defined(COMPILER_IS_MSC)
+	return _xgetbv(0);
+#endif
+}
+
+PRIVATE inline Bits32 QueryProcessorFeatures(void) {
+	PERSISTANT Boolean initialized = 0;
+	PERSISTANT Bits32 features = 0;
+	if (initialized) return features;
+
+	U32 r[4];
+	QueryCpuid(0, 0, r);
+	U32 maximumLeaf = r[0];
+	QueryCpuid(1, 0, r);
+	if (r[2] & 1 << 23) features |= PROCESSOR_FEATURE_POPCNT;
+	Boolean osxsave = !!(r[2] & 1 << 27);
+	if (maximumLeaf >= 7) {
+		/* NOTE(Emhyr): the system must also preserve the YMM and ZMM states */
+		U64 xcr0 = osxsave ? QueryXcr0() : 0;
+		Boolean ymm = (xcr0 & 0x06) == 0x06;
+		Boolean zmm = (xcr0 & 0xe6) == 0xe6;
+		QueryCpuid(7, 0, r);
+		if (r[1] & 1 << 3)          features |= PROCESSOR_FEATURE_BMI1;
+		if (r[1] & 1 << 8)          features |= PROCESSOR_FEATURE_BMI2;
+		if (ymm && r[1] & 1 << 5)   features |= PROCESSOR_FEATURE_AVX2;
+		if (zmm && r[1] & 1 << 16)  features |= PROCESSOR_FEATURE_AVX512F;
+		if (zmm && r[1] & 1 << 30)  features |= PROCESSOR_FEATURE_AVX512BW;
+		if (zmm && r[1] & 1u << 31) features |= PROCESSOR_FEATURE_AVX512VL;
+		if (zmm && r[2] & 1 << 14)  features |= PROCESSOR_FEATURE_AVX512POP;
+	}
+	initialized = 1;
+	return features;
+}
+
+#else
+
+PRIVATE inline Bits32 QueryProcessorFeatures(void) {
+	return 0;
+}
+
+#endif
+
 #endif
@@ -1,101 +1,139 @@
 #include "basics_bits.h"
 
+/* NOTE(Emhyr): the skippers return the first word from `p` to `q` that isn't
+`word`, or `q` if there's none. the vectorized ones are selected once by the
+processor's features, so there's no need for `/arch` flags */
+
+typedef Bits64 *WordSkipper(Bits64 *p, Bits64 *q, Bits64 word);
+
+PRIVATE Bits64 *SkipWords(Bits64 *p, Bits64 *q, Bits64 word) {
+	Boolean reverse = q < p;
+	for (; p != q; reverse ? --p : ++p)
+		if (*p != word) break;
+	return p;
+}
+
+#if defined(ARCHITECTURE_IS_X64)
+
+TARGETED("avx2") PRIVATE Bits64 *SkipWordsAvx2(Bits64 *p, Bits64 *q, Bits64 word) {
+	__m256i v = _mm256_set1_epi64x(word);
+	unsigned m;
+	if (p < q) {
+		for (; p != q && (Address)p & 31; ++p)
+			if (*p != word) return p;
+		for (; q - p >= 4; p += 4) {
+			m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi64(_mm256_load_si256((__m256i *)p), v));
+			if (m) return p + BitScanForward(m) / 8;
+		}
+	} else {
+		/* NOTE(Emhyr): the vectors are loaded from `p - 3` to `p` inclusively */
+		for (; p != q && (Address)(p + 1) & 31; --p)
+			if (*p != word) return p;
+		for (; p - q >= 4; p -= 4) {
+			m = ~(unsigned)_mm256_movemask_epi8(_mm256_cmpeq_epi64(_mm256_load_si256((__m256i *)(p - 3)), v));
+			if (m) return p - 3 + BitScanReverse(m) / 8;
+		}
+	}
+	return SkipWords(p, q, word);
+}
+
+/* NOTE(Emhyr): the head and the tail are handled with masked loads, which
+don't fault on the masked lanes */
+
+TARGETED("avx512f") PRIVATE Bits64 *SkipWordsAvx512(Bits64 *p, Bits64 *q, Bits64 word) {
+	if (p == q) return q;
+	__m512i v = _mm512_set1_epi64(word);
+	Bits64 *base = (Bits64 *)((Address)p & -64ll);
+	__mmask8 valid, m;
+	if (p < q) {
+		valid = (__mmask8)(0xff << (p - base));
+		for (;;) {
+			if (q - base < 8) valid &= (__mmask8)((1u << (q - base)) - 1);
+			m = _mm512_mask_cmpneq_epu64_mask(valid, _mm512_maskz_load_epi64(valid, base), v);
+			if (m) return base + BitScanForward(m);
+			base += 8;
+			if (base >= q) return q;
+			valid = 0xff;
+		}
+	} else {
+		valid = (__mmask8)(0xff >> (7 - (p - base)));
+		for (;;) {
+			if (q >= base) valid &= (__mmask8)(0xff << (q - base + 1));
+			m = _mm512_mask_cmpneq_epu64_mask(valid, _mm512_maskz_load_epi64(valid, base), v);
+			if (m) return base + BitScanReverse(m);
+			if (q >= base) return q;
+			base -= 8;
+			valid = 0xff;
+		}
+	}
+}
+
+#endif
+
+PRIVATE Bits64 *ResolveWordSkipper(Bits64 *p, Bits64 *q, Bits64 word);
+
+PRIVATE WordSkipper *skipWords = ResolveWordSkipper;
+
+PRIVATE Bits64 *ResolveWordSkipper(Bits64 *p, Bits64 *q, Bits64 word) {
+	WordSkipper *skipper = SkipWords;
+#if defined(ARCHITECTURE_IS_X64)
+	Bits32 features = QueryProcessorFeatures();
+	if (features & PROCESSOR_FEATURE_AVX512F)   skipper = SkipWordsAvx512;
+	else if (features & PROCESSOR_FEATURE_AVX2) skipper = SkipWordsAvx2;
+#endif
+	skipWords = skipper;
+	return skipper(p, q, word);
+}
+
 /* NOTE(Emhyr): "reverse" means to decrement the word pointer. it doesn't scan the bits reversely */
 
 BitLocation FindBit(Bits64 *p, Bits64 *q, Boolean clear) {
-	Boolean reverse = q < p;
 	Bits64 cmp = clear ? -1 : 0;
-	for (;;) {
-		if (p == q) goto fail;
-		if (*p != cmp) break;
-		if (reverse) --p;
-		else ++p;
-	}
+	p = skipWords(p, q, cmp);
+	if (p == q) return (BitLocation){0, 0};
 	Bits64 x = *p;
 	if (clear) x = ~x;
 	return (BitLocation){p, BitScanForward(x)};
-fail:
-	return (BitLocation){0, 0};
-	
-#if 0
-	/* NOTE(Emhyr): only works with 64 byte strides */
-	BitLocation result;
-	__mmask8 m;
-	__m512i v, cmp;
-	unsigned int zcnt;
-	
-	cmp = _mm512_set1_epi64(clear ? -1 : 0);
-	if (reverse) p -= 7;
-	for (;;) {
-		if (p == q) break;
-
-		v = _mm512_load_epi64(p);
-		m = _mm512_cmpneq_epu64_mask(v, cmp);
-		if (m) break;
+}
 
-		long long inc = sizeof(v) / sizeof(*p);
-		if (reverse) inc = -inc;
-		p += inc;
-	}
+/* NOTE(Emhyr): runs continue from the most significant bit of a word to the
+least significant bit of the next word, as `SetBits` sets them */
 
-	if (reverse) zcnt = 7 - _lzcnt_u32((unsigned)m << 24);
-	else zcnt = _tzcnt_u32(m);
-	result.pointer = p + zcnt;
-	if (result.pointer != q) {
-		Bits64 x = *result.pointer;
-		if (clear) x = ~x;
-		result.index = BitScanForward(x);
+PRIVATE inline Bits64 FindRunsWithinWord(Size n, Bits64 x) {
+	for (Size s = 1; s < n;) {
+		Size step = n - s < s ? n - s : s;
+		x &= x >> step;
+		s += step;
 	}
-	return result;
-#endif
+	return x;
 }
 
-/* NOTE(Emhyr): if n <= half a word size, we can buffer-shift bits into a word to
-compare with a bitmask. */
-
 BitLocation FindBits(Size n, Bits64 *p, Bits64 *q, Boolean clear) {
 	if (n == 1) return FindBit(p, q, clear);
 	Boolean reverse = q < p;
-	BitLocation result;
-	Size c, i, j, z;
-	Bits64 w;
-	
-	result.pointer = p;
-	result.index = 0;
-	c = 0;
+	BitLocation result = {0, 0};
+	Size run = 0;
 	for (; p != q; reverse ? --p : ++p) {
-		w = *p;
-		if (clear) w = ~w;
-	retry:
-		result.pointer = p;
-		i = BitScanForward(w);
-		if (!i) continue;
-		result.index = i - 1;
-		w |= ~(-1ll << (i - 1));
-		j = BitScanForward(~w);
-		if (!j) j = WIDTHOF(*p) + 1;
-		c += j - i;
-		if (c >= n) break;
-		w &= -1ll << (j - 1);
-		if (!w) continue;
-		if (j == WIDTHOF(*p) + 1) {
-			do {
-				w = *++p;
-				if (!clear) w = ~w;
-				if (p == q) goto finished;
-				z = _tzcnt_u64(w);
-				c += z;
-				if (c >= n) goto finished;
-			} while (z == WIDTHOF(*p));
-			w |= ~(-1ll << (z - 1));
-			w = ~w;
+		if (!run) {
+			p = skipWords(p, q, clear ? -1 : 0);
+			if (p == q) break;
 		}
-		c = 0;
-		goto retry;
+		Bits64 w = clear ? ~*p : *p;
+		if (w == (Bits64)-1) {
+			if (!run) result = (BitLocation){p, 0};
+			run += WIDTHOF(w);
+			if (run >= n) return result;
+			continue;
+		}
+		if (run && run + BitScanForward(~w) >= n) return result;
+		if (n <= WIDTHOF(w)) {
+			Bits64 runs = FindRunsWithinWord(n, w);
+			if (runs) return (BitLocation){p, BitScanForward(runs)};
+		}
+		run = WIDTHOF(w) - 1 - BitScanReverse(~w);
+		if (run) result = (BitLocation){p, WIDTHOF(w) - run};
 	}
-finished:
-	if (p == q) result = (BitLocation){0, 0};
-	return result;
+	return (BitLocation){0, 0};
 }
 
 void SetBits(Size n, BitLocation location, Boolean clear, Boolean reverse) {
@@ -103,30 +141,406 @@ void SetBits(Size n, BitLocation location, Boolean clear, Boolean reverse) {
 
 	/* TODO(Emhyr): discard `n` */
 	Bits64 *p, m;
-	long long i, k;
 	Size c;
 
 	p = location.pointer;
-	*p = 0;
-	c = WIDTHOF(*location.pointer) - location.index;
+	c = WIDTHOF(*p) - location.index;
 	if (n < c) c = n;
-	m = ~(c < 64 ? -1ll << c : 0) << location.index;
+	m = (c < WIDTHOF(m) ? ((Bits64)1 << c) - 1 : (Bits64)-1) << location.index;
 	if (clear) *p &= ~m;
 	else *p |= m;
-	if (reverse) --p;
-	else ++p;
 	n -= c;
-	if (!n) return;
-	c = WIDTHOF(*location.pointer);
-	k = n / c;
-	n -= c * k;
-	m = clear ? 0 : -1ll;
-	for (i = 0; i < k; ++i) {
-		*p = m;
+	m = clear ? 0 : (Bits64)-1;
+	for (; n >= WIDTHOF(m); n -= WIDTHOF(m)) {
 		if (reverse) --p;
 		else ++p;
+		*p = m;
 	}
-	m = -1ll >> (c - n);
+	if (!n) return;
+	if (reverse) --p;
+	else ++p;
+	m = ((Bits64)1 << n) - 1;
 	if (clear) *p &= ~m;
 	else *p |= m;
 }
+
+Boolean CheckBits(Size n, BitLocation location, Boolean clear, Boolean reverse) {
+	Assert(n);
+
+	Bits64 *p, m, w;
+	Size c;
+
+	p = location.pointer;
+	c = WIDTHOF(*p) - location.index;
+	if (n < c) c = n;
+	m = (c < WIDTHOF(m) ? ((Bits64)1 << c) - 1 : (Bits64)-1) << location.index;
+	w = clear ? ~*p : *p;
+	if ((w & m) != m) return 0;
+	n -= c;
+	for (; n >= WIDTHOF(m); n -= WIDTHOF(m)) {
+		if (reverse) --p;
+		else ++p;
+		if (*p != (clear ? 0 : (Bits64)-1)) return 0;
+	}
+	if (!n) return 1;
+	if (reverse) --p;
+	else ++p;
+	m = ((Bits64)1 << n) - 1;
+	w = clear ? ~*p : *p;
+	return (w & m) == m;
+}
+
+/******************************************************************************/
+
+/* NOTE(Emhyr): the counters and the combiners go forwards from `p` to `q`. the
+public procedures turn reverse ranges into forward ones beforehand */
+
+typedef Size WordCounter(const Bits64 *p, const Bits64 *q);
+
+/* NOTE(Emhyr): returns each byte's count of set bits within it. it's used
+instead of `CountWordBits` where `popcnt` may not be targeted, since that calls
+into the compiler's runtime */
+PRIVATE inline Bits64 CountBytesBits(Bits64 x) {
+	x -= x >> 1 & 0x5555555555555555;
+	x = (x & 0x3333333333333333) + (x >> 2 & 0x3333333333333333);
+	return (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0f;
+}
+
+PRIVATE inline Size CountWordBitsPortably(Bits64 x) {
+	return CountBytesBits(x) * 0x0101010101010101 >> 56;
+}
+
+PRIVATE Size CountWords(const Bits64 *p, const Bits64 *q) {
+	Size n = 0;
+	for (; p != q; ++p) n += CountWordBitsPortably(*p);
+	return n;
+}
+
+#if defined(ARCHITECTURE_IS_X64)
+
+TARGETED("popcnt") PRIVATE Size CountWordsPopcnt(const Bits64 *p, const Bits64 *q) {
+	Size n = 0;
+	for (; p != q; ++p) n += CountWordBits(*p);
+	return n;
+}
+
+/* NOTE(Emhyr): each nibble's bits are looked up by shuffling, and the bytes'
+counts are summed into each lane by `vpsadbw` */
+
+TARGETED("avx2,popcnt") PRIVATE Size CountWordsAvx2(const Bits64 *p, const Bits64 *q) {
+	const __m256i lookup = _mm256_setr_epi8(
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+		0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i nibbles = _mm256_set1_epi8(0x0f);
+	__m256i sums = _mm256_setzero_si256();
+	for (; q - p >= 4; p += 4) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)p);
+		__m256i l = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibbles));
+		__m256i h = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibbles));
+		sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_add_epi8(l, h), _mm256_setzero_si256()));
+	}
+	Size n = (Size)_mm256_extract_epi64(sums, 0) + (Size)_mm256_extract_epi64(sums, 1)
+	       + (Size)_mm256_extract_epi64(sums, 2) + (Size)_mm256_extract_epi64(sums, 3);
+	for (; p != q; ++p) n += CountWordBits(*p);
+	return n;
+}
+
+TARGETED("avx512f,avx512vpopcntdq") PRIVATE Size CountWordsAvx512(const Bits64 *p, const Bits64 *q) {
+	__m512i sums = _mm512_setzero_si512();
+	for (; q - p >= 8; p += 8)
+		sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_loadu_si512(p)));
+	if (p != q) {
+		__mmask8 valid = (__mmask8)((1u << (q - p)) - 1);
+		sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(valid, p)));
+	}
+	return (Size)_mm512_reduce_add_epi64(sums);
+}
+
+#endif
+
+PRIVATE Size ResolveWordCounter(const Bits64 *p, const Bits64 *q);
+
+PRIVATE WordCounter *countWords = ResolveWordCounter;
+
+PRIVATE Size ResolveWordCounter(const Bits64 *p, const Bits64 *q) {
+	WordCounter *counter = CountWords;
+#if defined(ARCHITECTURE_IS_X64)
+	Bits32 features = QueryProcessorFeatures();
+	if ((features & (PROCESSOR_FEATURE_AVX512F | PROCESSOR_FEATURE_AVX512POP)) == (PROCESSOR_FEATURE_AVX512F | PROCESSOR_FEATURE_AVX512POP))
+		counter = CountWordsAvx512;
+	else if ((features & (PROCESSOR_FEATURE_AVX2 | PROCESSOR_FEATURE_POPCNT)) == (PROCESSOR_FEATURE_AVX2 | PROCESSOR_FEATURE_POPCNT))
+		counter = CountWordsAvx2;
+	else if (features & PROCESSOR_FEATURE_POPCNT)
+		counter = CountWordsPopcnt;
+#endif
+	countWords = counter;
+	return counter(p, q);
+}
+
+Size CountBits(Bits64 *p, Bits64 *q) {
+	if (q < p) return countWords(q + 1, p + 1);
+	return countWords(p, q);
+}
+
+Size CountBitsWithin(Size n, BitLocation location, Boolean reverse) {
+	Assert(n);
+
+	Bits64 *p, m;
+	Size c, k, r;
+
+	p = location.pointer;
+	c = WIDTHOF(*p) - location.index;
+	if (n < c) c = n;
+	m = (c < WIDTHOF(m) ? ((Bits64)1 << c) - 1 : (Bits64)-1) << location.index;
+	r = CountWordBitsPortably(*p & m);
+	n -= c;
+	k = n / WIDTHOF(m);
+	if (k) {
+		r += reverse ? countWords(p - k, p) : countWords(p + 1, p + 1 + k);
+		p = reverse ? p - k : p + k;
+	}
+	n %= WIDTHOF(m);
+	if (!n) return r;
+	if (reverse) --p;
+	else ++p;
+	m = ((Bits64)1 << n) - 1;
+	return r + CountWordBitsPortably(*p & m);
+}
+
+/******************************************************************************/
+
+typedef void WordCombiner(Bits64 *p, Bits64 *q, const Bits64 *s, Size operation);
+
+PRIVATE void CombineWords(Bits64 *p, Bits64 *q, const Bits64 *s, Size operation) {
+	switch (operation) {
+	case BITS_AND:    for (; p != q; ++p, ++s) *p &= *s;  break;
+	case BITS_OR:     for (; p != q; ++p, ++s) *p |= *s;  break;
+	case BITS_XOR:    for (; p != q; ++p, ++s) *p ^= *s;  break;
+	case BITS_ANDNOT: for (; p != q; ++p, ++s) *p &= ~*s; break;
+	default: Assert(0, "invalid operation");
+	}
+}
+
+#if defined(ARCHITECTURE_IS_X64)
+
+#define COMBINE_WORDS_AVX2(e) \
+	for (; q - p >= 4; p += 4, s += 4) { \
+		__m256i a = _mm256_loadu_si256((const __m256i *)p); \
+		__m256i b = _mm256_loadu_si256((const __m256i *)s); \
+		_mm256_storeu_si256((__m256i *)p, e); \
+	}
+
+TARGETED("avx2") PRIVATE void CombineWordsAvx2(Bits64 *p, Bits64 *q, const Bits64 *s, Size operation) {
+	switch (operation) {
+	case BITS_AND:    COMBINE_WORDS_AVX2(_mm256_and_si256(a, b));    break;
+	case BITS_OR:     COMBINE_WORDS_AVX2(_mm256_or_si256(a, b));     break;
+	case BITS_XOR:    COMBINE_WORDS_AVX2(_mm256_xor_si256(a, b));    break;
+	case BITS_ANDNOT: COMBINE_WORDS_AVX2(_mm256_andnot_si256(b, a)); break;
+	}
+	CombineWords(p, q, s, operation);
+}
+
+#undef COMBINE_WORDS_AVX2
+
+#endif
+
+PRIVATE void ResolveWordCombiner(Bits64 *p, Bits64 *q, const Bits64 *s, Size operation);
+
+PRIVATE WordCombiner *combineWords = ResolveWordCombiner;
+
+PRIVATE void ResolveWordCombiner(Bits64 *p, Bits64 *q, const Bits64 *s, Size operation) {
+	WordCombiner *combiner = CombineWords;
+#if defined(ARCHITECTURE_IS_X64)
+	if (QueryProcessorFeatures() & PROCESSOR_FEATURE_AVX2) combiner = CombineWordsAvx2;
+#endif
+	combineWords = combiner;
+	combiner(p, q, s, operation);
+}
+
+void CombineBits(Bits64 *p, Bits64 *q, const Bits64 *source, Size operation) {
+	if (q < p) combineWords(q + 1, p + 1, source - (p - q - 1), operation);
+	else combineWords(p, q, source, operation);
+}
+
+/******************************************************************************/
+
+/* NOTE(Emhyr): the decoders write the indices of `word`'s set bits, offset by
+`base`, and return their count. the vectorized one may write up to
+`WIDTHOF(Bits64)` indices regardless, so it's only called with that much room */
+
+typedef Size WordDecoder(Bits64 word, Size base, Size *indices);
+
+PRIVATE Size DecodeWord(Bits64 word, Size base, Size *indices) {
+	Size n = 0;
+	for (; word; word &= word - 1) indices[n++] = base + BitScanForward(word);
+	return n;
+}
+
+#if defined(ARCHITECTURE_IS_X64)
+
+/* NOTE(Emhyr): `tzcnt` and `blsr` */
+TARGETED("bmi") PRIVATE Size DecodeWordBmi(Bits64 word, Size base, Size *indices) {
+	Size n = 0;
+	for (; word; word &= word - 1) indices[n++] = base + __builtin_ctzll(word);
+	return n;
+}
+
+/* NOTE(Emhyr): each byte of the word compresses the 8 indices that it covers.
+every store is full, but the next one overwrites what's beyond the compressed
+indices. sparse words are decoded by bits instead, since they'd waste most of
+the compressions */
+
+TARGETED("avx512f,bmi,popcnt") PRIVATE Size DecodeWordAvx512(Bits64 word, Size base, Size *indices) {
+	if (__builtin_popcountll(word) < 8) return DecodeWordBmi(word, base, indices);
+	__m512i lanes = _mm512_add_epi64(_mm512_set1_epi64(base), _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7));
+	const __m512i step = _mm512_set1_epi64(8);
+	Size n = 0;
+	for (Size i = 0; i < sizeof(word); ++i) {
+		__mmask8 m = (__mmask8)(word >> i * 8);
+		_mm512_storeu_si512(indices + n, _mm512_maskz_compress_epi64(m, lanes));
+		n += __builtin_popcount(m);
+		lanes = _mm512_add_epi64(lanes, step);
+	}
+	return n;
+}
+
+#endif
+
+PRIVATE Size ResolveWordDecoder(Bits64 word, Size base, Size *indices);
+
+PRIVATE WordDecoder *decodeWord = ResolveWordDecoder;
+
+PRIVATE Size ResolveWordDecoder(Bits64 word, Size base, Size *indices) {
+	WordDecoder *decoder = DecodeWord;
+#if defined(ARCHITECTURE_IS_X64)
+	Bits32 features = QueryProcessorFeatures();
+	Bits32 required = PROCESSOR_FEATURE_AVX512F | PROCESSOR_FEATURE_BMI1 | PROCESSOR_FEATURE_POPCNT;
+	if ((features & required) == required)      decoder = DecodeWordAvx512;
+	else if (features & PROCESSOR_FEATURE_BMI1) decoder = DecodeWordBmi;
+#endif
+	decodeWord = decoder;
+	return decoder(word, base, indices);
+}
+
+void BeginBitIteration(Bits64 *p, Bits64 *q, BitIterator *context) {
+	*context = (BitIterator){.beginning = p, .pointer = p, .ending = q};
+}
+
+Size IterateBits(Size capacity, Size *indices, BitIterator *context) {
+	Boolean reverse = context->ending < context->beginning;
+	Size n = 0;
+	for (;;) {
+		for (; context->word && n < capacity; context->word &= context->word - 1)
+			indices[n++] = context->base + BitScanForward(context->word);
+		if (context->word) break;
+
+		Bits64 *p = skipWords(context->pointer, context->ending, 0);
+		if (p == context->ending) {
+			context->pointer = p;
+			break;
+		}
+		context->pointer = reverse ? p - 1 : p + 1;
+		context->base = (reverse ? context->beginning - p : p - context->beginning) * WIDTHOF(Bits64);
+		if (capacity - n >= WIDTHOF(Bits64)) n += decodeWord(*p, context->base, indices + n);
+		else context->word = *p;
+	}
+	return n;
+}
+
+/******************************************************************************/
+
+#define GetIndexedWord(i, context) ((context)->reverse ? (context)->pointer - (i) : (context)->pointer + (i))
+
+/* NOTE(Emhyr): the blocks of indexed words, whose last one is partial */
+PRIVATE inline Size GaugeBitIndexBlocks(Size count) {
+	return (count + RANK_SAMPLE_WORDS - 1) / RANK_SAMPLE_WORDS;
+}
+
+/* NOTE(Emhyr): the count of the words from `first` to `ending` of the indexed words */
+PRIVATE inline Size CountIndexedWords(Size first, Size ending, BitIndex *context) {
+	if (first == ending) return 0;
+	if (context->reverse) return countWords(context->pointer - ending + 1, context->pointer - first + 1);
+	return countWords(context->pointer + first, context->pointer + ending);
+}
+
+Size GaugeBitIndexSize(Size count) {
+	Size ranks = GaugeBitIndexBlocks(count) + 1;
+	Size selects = count * WIDTHOF(Bits64) / SELECT_SAMPLE_BITS + 1;
+	return (ranks + selects) * sizeof(Size);
+}
+
+void IndexBits(Bits64 *p, Bits64 *q, void *memory, BitIndex *context) {
+	Assert(!((Address)memory & (sizeof(Size) - 1)), "unaligned memory");
+	context->reverse = q < p;
+	context->pointer = p;
+	context->count = context->reverse ? (Size)(p - q) : (Size)(q - p);
+
+	Size blocks = GaugeBitIndexBlocks(context->count);
+	context->ranks = memory;
+	context->selects = context->ranks + blocks + 1;
+	context->selectsCount = 0;
+
+	Size total = 0;
+	for (Size block = 0; block < blocks; ++block) {
+		Size first = block * RANK_SAMPLE_WORDS;
+		Size ending = first + RANK_SAMPLE_WORDS;
+		if (ending > context->count) ending = context->count;
+		context->ranks[block] = total;
+		total += CountIndexedWords(first, ending, context);
+		for (; context->selectsCount * SELECT_SAMPLE_BITS < total; ++context->selectsCount)
+			context->selects[context->selectsCount] = block;
+	}
+	context->ranks[blocks] = total;
+	context->total = total;
+}
+
+Size RankBits(Size index, BitIndex *context) {
+	Assert(index <= context->count * WIDTHOF(Bits64), "out of bounds");
+	Size word = index / WIDTHOF(Bits64);
+	Size bit = index % WIDTHOF(Bits64);
+	Size block = word / RANK_SAMPLE_WORDS;
+	Size rank = context->ranks[block] + CountIndexedWords(block * RANK_SAMPLE_WORDS, word, context);
+	if (bit) rank += CountWordBitsPortably(*GetIndexedWord(word, context) & (((Bits64)1 << bit) - 1));
+	return rank;
+}
+
+/* NOTE(Emhyr): returns the index of the first byte of `x` that's greater than
+`y`. each of `x`'s bytes must be below 128, and `y` must be too */
+PRIVATE inline Size FindGreaterByte(Bits64 x, Size y) {
+	Bits64 greater = ((x | 0x8080808080808080) - (y + 1) * 0x0101010101010101) & 0x8080808080808080;
+	return BitScanForward(greater) / 8;
+}
+
+/* NOTE(Emhyr): the bytes' cumulative counts find the bit's byte, and the
+byte's bits are spread into bytes to find the bit likewise, without branching */
+PRIVATE inline Size SelectBitWithinWord(Size rank, Bits64 x) {
+	Bits64 prefixes = CountBytesBits(x) * 0x0101010101010101;
+	Size byte = FindGreaterByte(prefixes, rank);
+	rank -= (prefixes << 8) >> byte * 8 & 0xff;
+	Bits64 bits = (x >> byte * 8 & 0xff) * 0x0101010101010101 & 0x8040201008040201;
+	bits = ((bits + 0x7f7f7f7f7f7f7f7f) | bits) >> 7 & 0x0101010101010101;
+	return byte * 8 + FindGreaterByte(bits * 0x0101010101010101, rank);
+}
+
+Size SelectBit(Size rank, BitIndex *context) {
+	if (rank >= context->total) return context->count * WIDTHOF(Bits64);
+
+	/* NOTE(Emhyr): the last block whose rank isn't greater than `rank` lies
+	between the samples */
+	Size sample = rank / SELECT_SAMPLE_BITS;
+	Size low = context->selects[sample];
+	Size high = sample + 1 < context->selectsCount ? context->selects[sample + 1] : GaugeBitIndexBlocks(context->count) - 1;
+	while (low < high) {
+		Size middle = low + (high - low + 1) / 2;
+		if (context->ranks[middle] <= rank) low = middle;
+		else high = middle - 1;
+	}
+
+	rank -= context->ranks[low];
+	for (Size word = low * RANK_SAMPLE_WORDS;; ++word) {
+		Bits64 x = *GetIndexedWord(word, context);
+		Size c = CountWordBitsPortably(x);
+		if (rank < c) return word * WIDTHOF(x) + SelectBitWithinWord(rank, x);
+		rank -= c;
+	}
+}
@@ -3,24 +3,139 @@
 
 #include "basics_base.h"
 
+/******************************************************************************/
+/* settings */
+
+/* the words that're counted by each sample of a bit index. ranks are computed
+by counting up to this many words after a sample */
+#if !defined(RANK_SAMPLE_WORDS)
+#define RANK_SAMPLE_WORDS 8
+#endif
+
+/* the set bits between each sample of a bit index's selections */
+#if !defined(SELECT_SAMPLE_BITS)
+#define SELECT_SAMPLE_BITS 4096
+#endif
+
+/******************************************************************************/
+
 #if defined(COMPILER_IS_CLANG) || defined(COMPILER_IS_GNUC)
+#define CountWordBits(x)  ((Size)__builtin_popcountll(x))
 #define BitScanForward(x) (__builtin_ffsll(x) - 1)
+#define BitScanReverse(x) ((x) ? (int)WIDTHOF(long long) - 1 - __builtin_clzll(x) : -1)
 #elif defined(COMPILER_IS_MSC)
+#define CountWordBits(x) ((Size)__popcnt64(x))
 INLINED int BitScanForward(long long int x) {
 	int r;
 	if (!_BitScanForward64(&r, x)) r = -1;
 	return r;
 }
+INLINED int BitScanReverse(long long int x) {
+	int r;
+	if (!_BitScanReverse64(&r, x)) r = -1;
+	return r;
+}
 #endif
 
 typedef struct {
 	Bits64 *pointer;
-	Index   index; /* NOTE(Emhyr): index begins at 1 from `*pointer` */
+	Index   index; /* NOTE(Emhyr): index begins at 0 from the least significant bit of `*pointer` */
 } BitLocation;
 
 PUBLIC BitLocation FindBit (Bits64 *p, Bits64 *q, Boolean clear);
 PUBLIC BitLocation FindBits(Size n, Bits64 *p, Bits64 *q, Boolean clear);
 
-PUBLIC void SetBits(Size n, BitLocation location, Boolean clear, Boolean reverse);
+PUBLIC void    SetBits  (Size n, BitLocation location, Boolean clear, Boolean reverse);
+PUBLIC Boolean CheckBits(Size n, BitLocation location, Boolean clear, Boolean reverse);
+
+/* bits / counting ************************************************************/
+
+/* NOTE(Emhyr): counts the set bits of the words from `p` to `q`, as `FindBit`
+traverses them */
+PUBLIC Size CountBits(Bits64 *p, Bits64 *q);
+
+/* NOTE(Emhyr): counts the set bits of `n` bits from `location`, as `SetBits`
+traverses them */
+PUBLIC Size CountBitsWithin(Size n, BitLocation location, Boolean reverse);
+
+/* bits / combination *********************************************************/
+
+#define BITS_AND    0
+#define BITS_OR     1
+#define BITS_XOR    2
+#define BITS_ANDNOT 3 /* NOTE(Emhyr): clears the bits that're set in the source */
+
+/* NOTE(Emhyr): combines each word from `p` to `q` with the word of `source`
+that's as far from it in the same direction. `source` may be `p`, but it
+shouldn't overlap it otherwise */
+PUBLIC void CombineBits(Bits64 *p, Bits64 *q, const Bits64 *source, Size operation);
+
+/* bits / iteration ***********************************************************/
+
+/*
+a bit iterator decodes the indices of the set bits from `p` to `q` in batches,
+so walks over the set bits don't restart their scans as `FindBit` would. the
+indices are numbered as they're traversed, as `BitIndex`'s are. the words
+shouldn't change while they're iterated.
+
+	BitIterator iterator;
+	BeginBitIteration(words, words + count, &iterator);
+	Size indices[256], n;
+	while ((n = IterateBits(COUNTOF(indices), indices, &iterator)))
+		for (Size i = 0; i < n; ++i) Visit(indices[i]);
+*/
+
+typedef struct {
+	Bits64 *beginning;
+	Bits64 *pointer;   /* NOTE(Emhyr): the next word */
+	Bits64 *ending;
+	Bits64  word;      /* NOTE(Emhyr): the undecoded bits of the current word */
+	Size    base;      /* NOTE(Emhyr): the index of the current word's first bit */
+} BitIterator;
+
+PUBLIC void BeginBitIteration(Bits64 *p, Bits64 *q, BitIterator *context);
+
+/* NOTE(Emhyr): decodes at most `capacity` indices into `indices`. returns the
+count, which is 0 when the iteration has ended */
+PUBLIC Size IterateBits(Size capacity, Size *indices, BitIterator *context);
+
+/* bits / indexing ************************************************************/
+
+/*
+a bit index samples the ranks of a bitset's words, so `RankBits` counts at most
+`RANK_SAMPLE_WORDS` words, and samples the positions of every
+`SELECT_SAMPLE_BITS`th set bit, so `SelectBit` searches only between two samples.
+
+the bits are indexed as they're traversed: the `i`th bit is bit `i % 64` of the
+`i / 64`th word from `p`. the index doesn't own its memory, which must be
+`GaugeBitIndexSize` bytes that're aligned by 8, and it must be rebuilt when the
+bitset changes.
+
+	BitIndex index;
+	IndexBits(words, words + count, Push(GaugeBitIndexSize(count), 8, &arena), &index);
+	Size before = RankBits(1000, &index);
+	Size third = SelectBit(2, &index);
+*/
+
+typedef struct {
+	Bits64 *pointer;
+	Size    count;   /* NOTE(Emhyr): in words */
+	Boolean reverse;
+	Size    total;   /* NOTE(Emhyr): the set bits */
+	Size   *ranks;   /* NOTE(Emhyr): the set bits before each block of words */
+	Size   *selects; /* NOTE(Emhyr): the block of every `SELECT_SAMPLE_BITS`th set bit */
+	Size    selectsCount;
+} BitIndex;
+
+PUBLIC Size GaugeBitIndexSize(Size count);
+
+PUBLIC void IndexBits(Bits64 *p, Bits64 *q, void *memory, BitIndex *context);
+
+/* NOTE(Emhyr): returns the set bits before `index` */
+PUBLIC Size RankBits(Size index, BitIndex *context);
+
+/* NOTE(Emhyr): returns the index of the set bit that has `rank` set bits
+before it, or the indexed bits' count if there's none */
+PUBLIC Size SelectBit(Size rank, BitIndex *context);
 
 #endif
@@ -1,3 +1,7 @@
+#if defined(__unix__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE /* NOTE(Emhyr): for `MAP_ANONYMOUS`, `MADV_*` and such under `-std=c11` */
+#endif
+
 #include "basics_memory.h"
 
 ASSERT(DEFAULT_FACTOR                           , "the factor can't be 0");
@@ -18,6 +22,17 @@ EXTERNAL void *CCALL memset (void *, int, unsigned long long);
 #define Zero(d, n)    Fill(d, 0, n)
 
 #define Maximum(a, b) ((a) >= (b) ? (a) : (b))
+#define Minimum(a, b) ((a) <= (b) ? (a) : (b))
+
+#if ENABLE_STATISTICS
+#define Record(context, member, n)           ((context)->statistics.member += (n))
+#define RecordAtomically(context, member, n) ((void)AtomicFetchAdd(&(context)->statistics.member, (n)))
+#define RecordMaximum(context, member, n)    ((context)->statistics.member = Maximum((context)->statistics.member, (n)))
+#else
+#define Record(context, member, n)           ((void)(n))
+#define RecordAtomically(context, member, n) ((void)(n))
+#define RecordMaximum(context, member, n)    ((void)(n))
+#endif
 
 /******************************************************************************/
 
@@ -30,11 +45,22 @@ EXTERNAL int __stdcall QueryPerformanceFrequency(unsigned long long *);
 
 EXTERNAL void __stdcall GetSystemInfo(void *);
 
+EXTERNAL void              *__stdcall CreateThread  (void *, unsigned long long, unsigned long (__stdcall *)(void *), void *, unsigned, unsigned *);
+EXTERNAL int                __stdcall CloseHandle   (void *);
+EXTERNAL void               __stdcall Sleep         (unsigned);
+EXTERNAL unsigned long long __stdcall GetTickCount64(void);
+
 EXTERNAL long long          __stdcall VirtualAlloc  (long long, unsigned long long, unsigned, unsigned);
 EXTERNAL int                __stdcall VirtualFree   (long long, unsigned long long, unsigned);
 EXTERNAL int                __stdcall VirtualProtect(long long, unsigned long long, unsigned, unsigned *);
 EXTERNAL unsigned long long __stdcall VirtualQuery  (long long, void *, unsigned long long);
 
+EXTERNAL void     *__stdcall GetCurrentProcess        (void);
+EXTERNAL long long __stdcall VirtualAllocExNuma       (void *, long long, unsigned long long, unsigned, unsigned, unsigned);
+EXTERNAL int       __stdcall GetNumaHighestNodeNumber (unsigned long *);
+EXTERNAL int       __stdcall GetNumaProcessorNode     (unsigned char, unsigned char *);
+EXTERNAL unsigned  __stdcall GetCurrentProcessorNumber(void);
+
 typedef union {
 	Byte _size[64];
 	struct {
@@ -63,8 +89,12 @@ Size QueryVirtualMemoryAllocationGranularity(void) {
 }
 #endif
 
+Address TryAllocateVirtualMemory(Size size) {
+	return VirtualAlloc(0, size, 0x00001000 | 0x00002000, 0x04);
+}
+
 Address AllocateVirtualMemory(Size size) {
-	Address result = VirtualAlloc(0, size, 0x00001000 | 0x00002000, 0x04);
+	Address result = TryAllocateVirtualMemory(size);
 	Assert(result, "");
 	return result;
 }
@@ -91,6 +121,11 @@ void DecommitVirtualMemory(Address address, Size size) {
 	Assert(result, "");
 }
 
+void ResetVirtualMemory(Address address, Size size) {
+	long long result = VirtualAlloc(address, size, 0x00080000, 0x04);
+	Assert(result, "");
+}
+
 void ValidateVirtualMemory(Address address, Size size) {
 	unsigned oldFlags;
 	int result = VirtualProtect(address, size, 0x04, &oldFlags);
@@ -103,6 +138,50 @@ void InvalidateVirtualMemory(Address address, Size size) {
 	Assert(result, "");
 }
 
+void PrefaultVirtualMemory(Address address, Size size) {
+	TouchVirtualMemory(address, size);
+}
+
+void CommitVirtualMemoryOnNode(Address address, Size size, Size node) {
+	long long result = VirtualAllocExNuma(GetCurrentProcess(), address, size, 0x00001000, 0x04, (unsigned)node);
+	Assert(result, "");
+}
+
+Size QueryNodesCount(void) {
+	unsigned long highest;
+	if (!GetNumaHighestNodeNumber(&highest)) return 1;
+	return highest + 1;
+}
+
+/* NOTE(Emhyr): only the processor's number within its group is queried */
+Size QueryCurrentNode(void) {
+	unsigned char node;
+	if (!GetNumaProcessorNode((unsigned char)GetCurrentProcessorNumber(), &node) || node == 0xff) return 0;
+	return node;
+}
+
+typedef void ThreadProcedure(void);
+
+PRIVATE unsigned long __stdcall RunThread(void *procedure) {
+	((ThreadProcedure *)procedure)();
+	return 0;
+}
+
+PRIVATE Boolean StartThread(ThreadProcedure *procedure) {
+	void *thread = CreateThread(0, 0, RunThread, (void *)procedure, 0, 0);
+	if (!thread) return 0;
+	CloseHandle(thread);
+	return 1;
+}
+
+PRIVATE void SleepMilliseconds(U64 milliseconds) {
+	Sleep((unsigned)milliseconds);
+}
+
+PRIVATE U64 QueryMilliseconds(void) {
+	return GetTickCount64();
+}
+
 Boolean CheckCommittedVirtualMemory(Address address, Size size) {
 	struct {
 		void              *BaseAddress;
@@ -119,6 +198,244 @@ Boolean CheckCommittedVirtualMemory(Address address, Size size) {
 
 }
 
+#elif defined(SYSTEM_IS_UNIX)
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+Size QueryVirtualMemoryGranularity(void) {
+	PERSISTANT Size pageSize = 0;
+	if (!pageSize) pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize;
+}
+
+Address TryAllocateVirtualMemory(Size size) {
+	void *result = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return result == MAP_FAILED ? 0 : (Address)result;
+}
+
+Address AllocateVirtualMemory(Size size) {
+	Address result = TryAllocateVirtualMemory(size);
+	Assert(result, "");
+	return result;
+}
+
+/* NOTE(Emhyr): `MAP_NORESERVE` so that the reservation isn't charged against
+the system's commit limit until it's committed */
+
+Address ReserveVirtualMemory(Size size) {
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+	size = AlignForwards(size, QueryVirtualMemoryGranularity());
+#if ENABLE_HUGE_PAGES
+	if (size >= HUGE_PAGE_SIZE) {
+		/* NOTE(Emhyr): over-reserve, then trim the misaligned head and the superfluous tail */
+		Byte *result = mmap(0, size + HUGE_PAGE_SIZE, PROT_NONE, flags, -1, 0);
+		Assert(result != MAP_FAILED, "");
+		Size head = GaugeForwardAligner((Address)result, HUGE_PAGE_SIZE);
+		if (head) munmap(result, head);
+		munmap(result + head + size, HUGE_PAGE_SIZE - head);
+		result += head;
+#if defined(MADV_HUGEPAGE)
+		madvise(result, size, MADV_HUGEPAGE);
+#endif
+		return (Address)result;
+	}
+#endif
+	void *result = mmap(0, size, PROT_NONE, flags, -1, 0);
+	Assert(result != MAP_FAILED, "");
+	return (Address)result;
+}
+
+void ReleaseVirtualMemory(Address address, Size size) {
+	int result = munmap((void *)address, AlignForwards(size, QueryVirtualMemoryGranularity()));
+	Assert(!result, "");
+}
+
+void CommitVirtualMemory(Address address, Size size) {
+	int result = mprotect((void *)address, size, PROT_READ | PROT_WRITE);
+	Assert(!result, "");
+}
+
+/* NOTE(Emhyr): the pages are also made inaccessible to trap like a decommit on
+Win64 would */
+
+void DecommitVirtualMemory(Address address, Size size) {
+	int result = -1;
+#if ENABLE_LAZY_DECOMMIT && defined(MADV_FREE)
+	result = madvise((void *)address, size, MADV_FREE);
+#endif
+	if (result) result = madvise((void *)address, size, MADV_DONTNEED);
+	Assert(!result, "");
+	result = mprotect((void *)address, size, PROT_NONE);
+	Assert(!result, "");
+}
+
+void ResetVirtualMemory(Address address, Size size) {
+	int result = -1;
+#if ENABLE_LAZY_DECOMMIT && defined(MADV_FREE)
+	result = madvise((void *)address, size, MADV_FREE);
+#endif
+	if (result) result = madvise((void *)address, size, MADV_DONTNEED);
+	Assert(!result, "");
+}
+
+void ValidateVirtualMemory(Address address, Size size) {
+	int result = mprotect((void *)address, size, PROT_READ | PROT_WRITE);
+	Assert(!result, "");
+}
+
+void InvalidateVirtualMemory(Address address, Size size) {
+	int result = mprotect((void *)address, size, PROT_NONE);
+	Assert(!result, "");
+}
+
+/* NOTE(Emhyr): `MADV_POPULATE_WRITE` faults the pages in one system call, but
+it's only since Linux 5.14 */
+
+void PrefaultVirtualMemory(Address address, Size size) {
+	int result = -1;
+#if defined(MADV_POPULATE_WRITE)
+	result = madvise((void *)address, size, MADV_POPULATE_WRITE);
+#endif
+	if (result) TouchVirtualMemory(address, size);
+}
+
+/* NOTE(Emhyr): `mbind` and `getcpu` are called through `syscall`, so there's no
+need for libnuma. the policy is preferred rather than bound, so the pages fall
+back to other nodes when the node's memory is exhausted. 1 is `MPOL_PREFERRED` */
+
+#define NODES_MASK_WORDS 16
+
+void CommitVirtualMemoryOnNode(Address address, Size size, Size node) {
+	CommitVirtualMemory(address, size);
+	unsigned long mask[NODES_MASK_WORDS] = {0};
+	if (node >= NODES_MASK_WORDS * WIDTHOF(*mask)) return;
+	mask[node / WIDTHOF(*mask)] = 1ul << node % WIDTHOF(*mask);
+	(void)syscall(SYS_mbind, address, size, 1, mask, NODES_MASK_WORDS * WIDTHOF(*mask) + 1, 0);
+}
+
+/* NOTE(Emhyr): "/sys/devices/system/node/possible" lists the nodes as ranges,
+e.g. "0-1" or "0,2-3", so the count is past the last number */
+Size QueryNodesCount(void) {
+	PERSISTANT Size count = 0;
+	if (count) return count;
+	Size result = 1;
+	int handle = open("/sys/devices/system/node/possible", O_RDONLY | O_CLOEXEC);
+	if (handle >= 0) {
+		char buffer[256];
+		ssize_t size = read(handle, buffer, sizeof(buffer) - 1);
+		close(handle);
+		Size number = 0;
+		for (ssize_t i = 0; i < size; ++i) {
+			if (buffer[i] >= '0' && buffer[i] <= '9') number = number * 10 + (buffer[i] - '0');
+			else {
+				if (i && buffer[i - 1] >= '0' && buffer[i - 1] <= '9') result = Maximum(result, number + 1);
+				number = 0;
+			}
+		}
+	}
+	count = result;
+	return count;
+}
+
+Size QueryCurrentNode(void) {
+	unsigned processor, node;
+	if (syscall(SYS_getcpu, &processor, &node, 0)) return 0;
+	return node;
+}
+
+typedef void ThreadProcedure(void);
+
+PRIVATE void *RunThread(void *procedure) {
+	((ThreadProcedure *)procedure)();
+	return 0;
+}
+
+PRIVATE Boolean StartThread(ThreadProcedure *procedure) {
+	pthread_t thread;
+	if (pthread_create(&thread, 0, RunThread, (void *)procedure)) return 0;
+	pthread_detach(thread);
+	return 1;
+}
+
+PRIVATE void SleepMilliseconds(U64 milliseconds) {
+	struct timespec t = {.tv_sec = milliseconds / 1000, .tv_nsec = milliseconds % 1000 * 1000000};
+	nanosleep(&t, 0);
+}
+
+PRIVATE U64 QueryMilliseconds(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (U64)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/* NOTE(Emhyr): there's no system call to query the protection of pages, so we
+scan "/proc/self/maps" for readable and writable mappings that cover the
+addresses. this is slow, but it's only meant for debugging */
+
+PRIVATE Size ParseHexadecimal(const Byte **cursor) {
+	Size result = 0;
+	for (;; ++*cursor) {
+		Byte c = **cursor;
+		if      (c >= '0' && c <= '9') result = result * 16 + (c - '0');
+		else if (c >= 'a' && c <= 'f') result = result * 16 + (c - 'a' + 10);
+		else break;
+	}
+	return result;
+}
+
+Boolean CheckCommittedVirtualMemory(Address address, Size size) {
+	Boolean result = 0;
+	int file = open("/proc/self/maps", O_RDONLY);
+	if (file < 0) return 0;
+
+	Byte buffer[4096];
+	Size length = 0;
+	Address cursor = address;
+	Address ending = address + (size ? size : 1);
+	for (;;) {
+		long long n = read(file, buffer + length, sizeof(buffer) - 1 - length);
+		if (n <= 0) break;
+		length += n;
+		buffer[length] = 0;
+
+		const Byte *line = buffer;
+		for (;;) {
+			const Byte *newline = line;
+			while (*newline && *newline != '\n') ++newline;
+			if (!*newline) break;
+
+			const Byte *p = line;
+			Address beginning = ParseHexadecimal(&p);
+			++p;
+			Address end = ParseHexadecimal(&p);
+			++p;
+			Boolean accessible = p[0] == 'r' && p[1] == 'w';
+			if (beginning > cursor) goto finished;
+			if (cursor < end) {
+				if (!accessible) goto finished;
+				cursor = end;
+				if (cursor >= ending) {
+					result = 1;
+					goto finished;
+				}
+			}
+			line = newline + 1;
+		}
+		length -= line - buffer;
+		Move(buffer, line, length);
+	}
+
+finished:
+	close(file);
+	return result;
+}
+
 #endif
 
 
@@ -133,27 +450,17 @@ PRIVATE inline Address GetNextPage(Size *granularity, Address address) {
 	return AlignForwards(address, *granularity);
 }
 
-PRIVATE inline void DoNextPages(Boolean doAll, void (*procedure)(Address, Size), Address address, Address ending) {
+PRIVATE inline Size DoNextPages(Boolean doAll, void (*procedure)(Address, Size), Address address, Address ending) {
 	Size size;
 	Address nextPage = GetNextPage(&size, address);
 	if (nextPage < ending) {
 		if (doAll) size *= (ending - nextPage) / size;
 		procedure(nextPage, size);
+		return size;
 	}
+	return 0;
 }
 
-PRIVATE inline void DecommitNextPage(Address address, Address ending) {
-	DoNextPages(0, DecommitVirtualMemory, address, ending);
-}
-
-#define DecommitNextPageWithContext(context)  DecommitNextPage((context)->address + (context)->extent, (context)->address + (context)->reservation)
-
-PRIVATE inline void DecommitNextPages(Address address, Address ending) {
-	DoNextPages(1, DecommitVirtualMemory, address, ending);
-}
-
-#define DecommitNextPagesWithContext(context) DecommitNextPages((context)->address + (context)->extent, (context)->address + (context)->reservation)
-
 PRIVATE inline void InvalidateNextPage(Address address, Address ending) {
 	DoNextPages(0, InvalidateVirtualMemory, address, ending);
 }
@@ -166,6 +473,35 @@ PRIVATE inline void InvalidateNextPages(Address address, Address ending) {
 
 #define InvalidateNextPagesWithContext(context) InvalidateNextPages((context)->address + (context)->extent, (context)->address + (context)->commission)
 
+#if ENABLE_PREFAULTING
+#define PrefaultCommittedVirtualMemory(address, size) PrefaultVirtualMemory(address, size)
+#else
+#define PrefaultCommittedVirtualMemory(address, size) ((void)0)
+#endif
+
+#define CommitVirtualMemoryWithContext(context, address, size) do {      \
+	Address address_ = (address);                                    \
+	Size size_ = (size);                                             \
+	if ((context)->affinity)                                         \
+		CommitVirtualMemoryOnNode(address_, size_, (context)->affinity - 1); \
+	else CommitVirtualMemory(address_, size_);                       \
+	PrefaultCommittedVirtualMemory(address_, size_);                 \
+	Record(context, commits, 1);                                     \
+	Record(context, committed, size_);                               \
+} while (0)
+
+#define DecommitVirtualMemoryWithContext(context, address, size) do { \
+	Size size_ = (size);                                          \
+	DecommitVirtualMemory(address, size_);                        \
+	Record(context, decommitted, size_);                          \
+} while (0)
+
+#define ResetVirtualMemoryWithContext(context, address, size) do { \
+	Size size_ = (size);                                       \
+	ResetVirtualMemory(address, size_);                        \
+	Record(context, decommitted, size_);                       \
+} while (0)
+
 /* validation *****************************************************************/
 
 #define VALIDATECONTEXT1(context) do {                               \
@@ -205,6 +541,347 @@ PRIVATE inline void InvalidateNextPages(Address address, Address ending) {
 
 /* linear allocator ***********************************************************/
 
+/* linear allocator / persistence *********************************************/
+
+#if defined(SYSTEM_IS_UNIX)
+
+#define PERSISTENCE_SIGNATURE 0x3130616e65726162ull /* NOTE(Emhyr): "barena01" */
+
+typedef struct {
+	U64     signature;
+	Address base;
+	Size    extent;
+} PersistentHeader;
+
+/* NOTE(Emhyr): the header's page precedes the allocator's address */
+PRIVATE inline PersistentHeader *GetPersistentHeader(LinearAllocator *context) {
+	return (PersistentHeader *)(context->address - QueryVirtualMemoryGranularity());
+}
+
+/* NOTE(Emhyr): the whole reservation maps the file from the beginning, so
+raising the commission only extends the file. the pages beyond the file's end
+trap until then, like uncommitted pages. the extension reads as zeros */
+PRIVATE void ExtendPersistence(Size commission, LinearAllocator *context) {
+	int result = ftruncate((int)context->persistence->handle, QueryVirtualMemoryGranularity() + commission);
+	Assert(!result, "couldn't extend the file");
+}
+
+Boolean OpenPersistentLinearAllocator(const char *path, Address base, Persistence *persistence, LinearAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	/* NOTE(Emhyr): `memfd_create` is called through `syscall`, since its
+	declaration needs `_GNU_SOURCE`. 1 is `MFD_CLOEXEC` */
+	int handle = path ? open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644) : (int)syscall(SYS_memfd_create, "basics", 1u);
+	if (handle < 0) return 0;
+
+	struct stat status;
+	PersistentHeader header = {0};
+	if (fstat(handle, &status)) goto failed;
+	Size size = (Size)status.st_size;
+	if (size) {
+		if (size < pageSize || size % pageSize) goto failed;
+		if (pread(handle, &header, sizeof(header), 0) != sizeof(header)) goto failed;
+		if (header.signature != PERSISTENCE_SIGNATURE) goto failed;
+		base = header.base;
+	} else {
+		if (ftruncate(handle, pageSize)) goto failed;
+		size = pageSize;
+	}
+
+	Size commission = size - pageSize;
+	if (header.extent > commission) goto failed;
+	if (!context->reservation) context->reservation = DEFAULT_RESERVATION;
+	if (!context->factor)      context->factor      = DEFAULT_FACTOR;
+	context->reservation = AlignForwards(Maximum(context->reservation, commission), pageSize);
+
+	int flags = MAP_SHARED | MAP_NORESERVE;
+#if defined(MAP_FIXED_NOREPLACE)
+	if (base) flags |= MAP_FIXED_NOREPLACE;
+#endif
+	void *mapping = mmap(base ? (void *)(base - pageSize) : 0, pageSize + context->reservation, PROT_READ | PROT_WRITE, flags, handle, 0);
+	if (mapping == MAP_FAILED && base) mapping = mmap(0, pageSize + context->reservation, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, handle, 0);
+	if (mapping == MAP_FAILED) goto failed;
+
+	context->address     = (Address)mapping + pageSize;
+	context->commission  = commission;
+	context->extent      = header.extent;
+	context->persistence = persistence;
+	*persistence = (Persistence){.handle = handle};
+	persistence->relocated = header.signature && header.base != context->address;
+	if (!header.signature) *GetPersistentHeader(context) = (PersistentHeader){PERSISTENCE_SIGNATURE, context->address, 0};
+	return 1;
+
+failed:
+	close(handle);
+	return 0;
+}
+
+void SyncPersistentLinearAllocator(LinearAllocator *context) {
+	Assert(!context->persistence->snapshotted, "the snapshot's writes aren't the file's yet");
+	Size pageSize = QueryVirtualMemoryGranularity();
+	GetPersistentHeader(context)->extent = context->extent;
+	int result = msync((void *)(context->address - pageSize), pageSize + AlignForwards(context->extent, pageSize), MS_SYNC);
+	Assert(!result, "");
+}
+
+/* NOTE(Emhyr): the file is truncated to the extent's pages */
+void ClosePersistentLinearAllocator(LinearAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Persistence *persistence = context->persistence;
+	SyncPersistentLinearAllocator(context);
+	ReleaseVirtualMemory(context->address - pageSize, pageSize + context->reservation);
+	int result = ftruncate((int)persistence->handle, pageSize + AlignForwards(context->extent, pageSize));
+	Assert(!result, "");
+	close((int)persistence->handle);
+	context->address     = 0;
+	context->commission  = 0;
+	context->extent      = 0;
+	context->persistence = 0;
+}
+
+/* linear allocator / snapshots ***********************************************/
+
+/* NOTE(Emhyr): maps the allocator's reservation from the file after the header */
+PRIVATE void RemapPersistence(Boolean private, LinearAllocator *context) {
+	int flags = (private ? MAP_PRIVATE : MAP_SHARED) | MAP_FIXED | MAP_NORESERVE;
+	void *result = mmap((void *)context->address, context->reservation, PROT_READ | PROT_WRITE, flags, (int)context->persistence->handle, QueryVirtualMemoryGranularity());
+	Assert(result != MAP_FAILED, "");
+}
+
+void SnapshotLinearAllocator(LinearAllocator *context) {
+	Persistence *persistence = context->persistence;
+	Assert(persistence, "only persistent allocators can be snapshotted");
+	Assert(!persistence->snapshotted, "there's already a snapshot");
+	RemapPersistence(1, context);
+	persistence->snapshotted        = 1;
+	persistence->snapshotExtent     = context->extent;
+	persistence->snapshotCommission = context->commission;
+}
+
+/* NOTE(Emhyr): a touched page was copied privately, so it's anonymous rather
+than the file's. "/proc/self/pagemap" tells them apart by bit 61, and by bits 62
+and 63 whether they're swapped or present. without it, every page is written
+back */
+
+#define PAGEMAP_FILE      ((U64)1 << 61)
+#define PAGEMAP_SWAPPED   ((U64)1 << 62)
+#define PAGEMAP_PRESENT   ((U64)1 << 63)
+#define PAGEMAP_BATCH     512
+
+void CommitLinearSnapshot(LinearAllocator *context) {
+	Persistence *persistence = context->persistence;
+	Assert(persistence && persistence->snapshotted, "there's no snapshot");
+	Size pageSize = QueryVirtualMemoryGranularity();
+	int handle = (int)persistence->handle;
+	Size pages = context->commission / pageSize;
+	int pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+	U64 entries[PAGEMAP_BATCH];
+	for (Size first = 0; first < pages; first += PAGEMAP_BATCH) {
+		Size count = Minimum(pages - first, PAGEMAP_BATCH);
+		Address address = context->address + first * pageSize;
+		Boolean didRead = pagemap >= 0 && pread(pagemap, entries, count * sizeof(U64), address / pageSize * sizeof(U64)) == (ssize_t)(count * sizeof(U64));
+		for (Size i = 0; i < count; ++i) {
+			if (didRead && (!(entries[i] & (PAGEMAP_PRESENT | PAGEMAP_SWAPPED)) || entries[i] & PAGEMAP_FILE)) continue;
+			ssize_t result = pwrite(handle, (void *)(address + i * pageSize), pageSize, pageSize + (first + i) * pageSize);
+			Assert(result == (ssize_t)pageSize, "couldn't write the snapshot back");
+		}
+	}
+	if (pagemap >= 0) close(pagemap);
+	RemapPersistence(0, context);
+	persistence->snapshotted = 0;
+}
+
+/* NOTE(Emhyr): the file is truncated back to the snapshot's commission, which
+also releases whatever was committed since */
+void DiscardLinearSnapshot(LinearAllocator *context) {
+	Persistence *persistence = context->persistence;
+	Assert(persistence && persistence->snapshotted, "there's no snapshot");
+	RemapPersistence(0, context);
+	if (context->commission > persistence->snapshotCommission) {
+		int result = ftruncate((int)persistence->handle, QueryVirtualMemoryGranularity() + persistence->snapshotCommission);
+		Assert(!result, "");
+	}
+	context->extent      = persistence->snapshotExtent;
+	context->commission  = persistence->snapshotCommission;
+	persistence->snapshotted = 0;
+}
+
+#else
+
+/* TODO(Emhyr): Win64's file mappings can't be extended in place without
+`NtExtendSection` or placeholders */
+
+PRIVATE void ExtendPersistence(Size commission, LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+Boolean OpenPersistentLinearAllocator(const char *path, Address base, Persistence *persistence, LinearAllocator *context) {
+	return 0;
+}
+
+void SyncPersistentLinearAllocator(LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+void ClosePersistentLinearAllocator(LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+void SnapshotLinearAllocator(LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+void CommitLinearSnapshot(LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+void DiscardLinearSnapshot(LinearAllocator *context) {
+	Assert(0, "unsupported");
+}
+
+#endif
+
+/* linear allocator / waning **************************************************/
+
+/* NOTE(Emhyr): queued policies are only dequeued and released while holding
+the reclaimer's lock, so that a detached policy is never touched afterwards.
+the policy's lock guards the allocator's commission against its owner. the
+reclaimer runs only while the queue isn't empty, and `started` is only touched
+while holding its lock, so that it's restarted for any policy queued after it
+has seen the queue drained */
+PRIVATE struct {
+	volatile Word lock;
+	volatile Word started;
+	WaningPolicy *queue;
+} reclaimer;
+
+/* NOTE(Emhyr): decommits what's committed beyond the commission */
+PRIVATE void ReleaseWaned(WaningPolicy *policy) {
+	LinearAllocator *allocator = policy->allocator;
+	AcquireLock(&policy->lock);
+	if (policy->committed > allocator->commission) {
+		DecommitVirtualMemoryWithContext(allocator, allocator->address + allocator->commission, policy->committed - allocator->commission);
+		policy->committed = allocator->commission;
+	}
+	ReleaseLock(&policy->lock);
+}
+
+PRIVATE void Reclaim(void) {
+	for (;;) {
+		U64 now = QueryMilliseconds();
+		U64 period = WANING_PERIOD;
+		AcquireLock(&reclaimer.lock);
+		for (WaningPolicy **link = &reclaimer.queue; *link;) {
+			WaningPolicy *policy = *link;
+			if (policy->deadline > now) {
+				period = Minimum(period, policy->deadline - now);
+				link = &policy->next;
+				continue;
+			}
+			*link = policy->next;
+			policy->queued = 0;
+			ReleaseWaned(policy);
+		}
+		if (!reclaimer.queue) {
+			reclaimer.started = 0;
+			ReleaseLock(&reclaimer.lock);
+			return;
+		}
+		ReleaseLock(&reclaimer.lock);
+		SleepMilliseconds(period);
+	}
+}
+
+PRIVATE void QueueWaned(WaningPolicy *policy) {
+	AcquireLock(&reclaimer.lock);
+	policy->deadline = QueryMilliseconds() + policy->delay;
+	if (!policy->queued) {
+		policy->queued = 1;
+		policy->next = reclaimer.queue;
+		reclaimer.queue = policy;
+	}
+	Boolean starting = !reclaimer.started;
+	reclaimer.started = 1;
+	ReleaseLock(&reclaimer.lock);
+
+	/* NOTE(Emhyr): if the reclaimer can't be started, the policy stays queued
+	until the next attempt */
+	if (starting && !StartThread(Reclaim)) {
+		AcquireLock(&reclaimer.lock);
+		reclaimer.started = 0;
+		ReleaseLock(&reclaimer.lock);
+	}
+}
+
+/* NOTE(Emhyr): lowers the commission to the extent. with a policy, nothing is
+lowered within the high watermark, and the decommit is left to the reclaimer */
+PRIVATE void Wane(LinearAllocator *context) {
+	if (context->persistence) return;
+	Size granularity = QueryVirtualMemoryGranularity();
+	Size extent = AlignForwards(context->extent, granularity);
+	if (extent >= context->commission) return;
+
+	WaningPolicy *policy = context->waning;
+	if (!policy) {
+		DecommitVirtualMemoryWithContext(context, context->address + extent, context->commission - extent);
+		context->commission = extent;
+		return;
+	}
+
+	if (context->commission - extent <= policy->highWatermark) return;
+	Size commission = Minimum(AlignForwards(extent + policy->lowWatermark, granularity), context->commission);
+	AcquireLock(&policy->lock);
+	policy->committed = Maximum(policy->committed, context->commission);
+	context->commission = commission;
+	ReleaseLock(&policy->lock);
+	QueueWaned(policy);
+}
+
+/* NOTE(Emhyr): raises the commission, reclaiming any pages that are waned but
+not yet decommitted. returns the offset beyond which the pages are fresh */
+PRIVATE Size Wax(Size commission, LinearAllocator *context) {
+	WaningPolicy *policy = context->waning;
+	Size committed = context->commission;
+	if (policy) {
+		AcquireLock(&policy->lock);
+		committed = Maximum(committed, policy->committed);
+	}
+	if (commission > committed) {
+		if (context->persistence) ExtendPersistence(commission, context);
+		else CommitVirtualMemoryWithContext(context, context->address + committed, commission - committed);
+	}
+	context->commission = commission;
+	if (policy) {
+		policy->committed = Maximum(committed, commission);
+		ReleaseLock(&policy->lock);
+	}
+	return committed;
+}
+
+void AttachWaningPolicy(WaningPolicy *policy, LinearAllocator *context) {
+	policy->lock      = 0;
+	policy->allocator = context;
+	policy->committed = context->commission;
+	policy->deadline  = 0;
+	policy->queued    = 0;
+	policy->next      = 0;
+	context->waning   = policy;
+}
+
+void DetachWaningPolicy(LinearAllocator *context) {
+	WaningPolicy *policy = context->waning;
+	if (!policy) return;
+	AcquireLock(&reclaimer.lock);
+	if (policy->queued) {
+		WaningPolicy **link = &reclaimer.queue;
+		while (*link != policy) link = &(*link)->next;
+		*link = policy->next;
+		policy->queued = 0;
+	}
+	ReleaseWaned(policy);
+	ReleaseLock(&reclaimer.lock);
+	context->waning = 0;
+}
+
 /* linear allocator / creation ************************************************/
 
 void InitializeLinearAllocator(LinearAllocator *context) {
@@ -212,7 +889,7 @@ void InitializeLinearAllocator(LinearAllocator *context) {
 	if (!context->address)     context->address     = ReserveVirtualMemory(context->reservation);
 	if (!context->commission)  context->commission  = DEFAULT_COMMISSION;
 	if (!context->factor)      context->factor      = DEFAULT_FACTOR;
-	CommitVirtualMemory(context->address, context->commission);
+	CommitVirtualMemoryWithContext(context, context->address, context->commission);
 }
 
 LinearAllocator MakeLinearAllocator(Size reservation, Size commission, Size factor) {
@@ -239,10 +916,7 @@ void ClearLinearAllocator(LinearAllocator *context) {
 }
 
 PRIVATE inline void DoClearLinearAllocatorWaned(LinearAllocator *context) {
-	if (context->commission) {
-		DecommitVirtualMemory(context->address, context->commission);
-		context->commission = 0;
-	}
+	Wane(context);
 }
 
 void ClearLinearAllocatorWaned(LinearAllocator *context) {
@@ -263,6 +937,18 @@ void DebugClearLinearAllocatorWaned(LinearAllocator *context) {
 
 /* linear allocator / allocation **********************************************/
 
+/* NOTE(Emhyr): the commission is multiplied by the factor, by at least
+`MINIMUM_COMMISSION`, and by at least enough for `extent`. assumes that
+`extent` is within the reservation */
+PRIVATE inline Size GaugeCommission(Size extent, LinearAllocator *context) {
+	Size result = Maximum(context->commission * context->factor, context->commission + MINIMUM_COMMISSION);
+	result = AlignForwards(Maximum(result, extent), QueryVirtualMemoryGranularity());
+	if (result > context->reservation) result = context->reservation;
+	return result;
+}
+
+/* NOTE(Emhyr): `*doZero` is cleared if the allocation lies entirely in freshly
+committed pages, which are already zeroed */
 PRIVATE inline void *DoPush(Boolean *doZero, Size size, Size alignment, LinearAllocator *context) {
 #if ENABLE_AUTOMATIC_INITIALIZATION
 	if (!context->address) InitializeLinearAllocator(context);
@@ -270,24 +956,27 @@ PRIVATE inline void *DoPush(Boolean *doZero, Size size, Size alignment, LinearAl
 
 	void *result;
 	Size aligner = GaugeForwardAligner(context->address + context->extent, alignment);
-	if (context->extent + aligner + size > context->commission) {
-		Size pageSize = QueryVirtualMemoryGranularity();
-		Size commission = AlignForwards(aligner + size, pageSize);
-		if (size > pageSize / context->factor) commission *= context->factor;
-		if (context->commission + commission <= context->reservation) {
-			CommitVirtualMemory(context->address + context->commission, size);
-			context->commission += commission;
-			*doZero = 0;
-		} else {
+	Size extent = context->extent + aligner + size;
+	*doZero = 1;
+	if (extent > context->commission) {
+		if (extent > context->reservation) {
 			result = 0;
 			*doZero = 0;
 			goto finished;
 		}
+		Size committed = Wax(GaugeCommission(extent, context), context);
+#if !ENABLE_LAZY_DECOMMIT
+		if (context->extent + aligner >= committed) *doZero = 0;
+#else
+		(void)committed;
+#endif
 	}
 
 	context->extent += aligner;
 	result = (void *)(context->address + context->extent);
 	context->extent += size;
+	Record(context, pushes, 1);
+	RecordMaximum(context, highestExtent, context->extent);
 
 finished:
 	return result;
@@ -317,7 +1006,7 @@ PRIVATE inline FrameHeader *GetFrameHeader(Address address) {
 
 void *PushFrame(Size size, Size alignment, LinearAllocator *context) {
 #if ENABLE_AUTOMATIC_INITIALIZATION
-	InitializeLinearAllocator(context);
+	if (!context->address) InitializeLinearAllocator(context);
 #endif
 
 	/* NOTE(Emhyr): we just need enough space for an aligned header before the aligned allocation */
@@ -370,33 +1059,54 @@ void *DebugPushFrameZeroed(Size size, Size alignment, LinearAllocator *context)
 	return result;
 }
 
+/* NOTE(Emhyr): only the last push is resized in place. others shrink in place,
+but their surplus isn't reclaimed */
+void *Repush(void *address, Size size, Size newSize, Size alignment, LinearAllocator *context) {
+	Address ending = (Address)address + size;
+	if (ending == context->address + context->extent) {
+		if (newSize <= size) {
+			context->extent -= size - newSize;
+			return address;
+		}
+		if (!Push(newSize - size, 1, context)) return 0;
+		return address;
+	}
+	if (newSize <= size) return address;
+	void *result = Push(newSize, alignment, context);
+	if (result) Copy(result, address, size);
+	return result;
+}
+
 /* linear allocator / deallocation ********************************************/
 
 PRIVATE inline Size GetPullExtent(Boolean *didUnderflow, Size size, Size alignment, LinearAllocator *context) {
-	Size address = context->address + context->extent;
-	Size newAddress = AlignBackwards(address - size, alignment);
-	*didUnderflow = newAddress < address;
-	return *didUnderflow ? 0 : newAddress - address;
+	*didUnderflow = size > context->extent;
+	if (*didUnderflow) return 0;
+	Size newAddress = AlignBackwards(context->address + context->extent - size, alignment);
+	*didUnderflow = newAddress < (Size)context->address;
+	return *didUnderflow ? 0 : newAddress - context->address;
 }
 
 void Pull(Size size, Size alignment, LinearAllocator *context) {
 	Boolean didUnderflow;
 	context->extent = GetPullExtent(&didUnderflow, size, alignment, context);
+	Record(context, pulls, 1);
 }
 
 void PullWaned(Size size, Size alignment, LinearAllocator *context) {
 	Pull(size, alignment, context);
-	DecommitNextPageWithContext(context);
+	Wane(context);
 }
 
 void PullFrame(void *address, LinearAllocator *context) {
 	FrameHeader *header = GetFrameHeader((Address)address);
 	context->extent = header->extent;
+	Record(context, pulls, 1);
 }
 
 void PullFrameWaned(void *address, LinearAllocator *context) {
 	PullFrame(address, context);
-	DecommitNextPageWithContext(context);
+	Wane(context);
 }
 
 PRIVATE inline void DoDebugPull(Size size, Size alignment, LinearAllocator *context) {
@@ -406,6 +1116,7 @@ PRIVATE inline void DoDebugPull(Size size, Size alignment, LinearAllocator *cont
 	Size extent = GetPullExtent(&didUnderflow, size, alignment, context);
 	Assert(!didUnderflow, "underflowed! if attempted to clear, use `ClearLinearAllocator`");
 	context->extent = extent;
+	Record(context, pulls, 1);
 }
 
 void DebugPull(Size size, Size alignment, LinearAllocator *context) {
@@ -414,7 +1125,7 @@ void DebugPull(Size size, Size alignment, LinearAllocator *context) {
 
 void DebugPullWaned(Size size, Size alignment, LinearAllocator *context) {
 	DoDebugPull(size, alignment, context);
-	DecommitNextPagesWithContext(context);
+	Wane(context);
 }
 
 void DebugPullFrame(void *address, LinearAllocator *context) {
@@ -426,80 +1137,701 @@ void DebugPullFrame(void *address, LinearAllocator *context) {
 
 void DebugPullFrameWaned(void *address, LinearAllocator *context) {
 	DebugPullFrame(address, context);
-	DecommitNextPagesWithContext(context);
+	Wane(context);
 }
 
-/* granular allocator *********************************************************/
-
-/*
+/* scratch arenas *************************************************************/
 
-the flags actually tails the allocator's memory in reverse word order. this is
-to enable the ability to increase the amount of entries without moving any bytes,
-and also allowed
+PRIVATE THREADIC LinearAllocator scratches[SCRATCH_ARENAS_COUNT];
 
-"reverse word order" means that you can traverse the flags as follows:
+LinearAllocator *GetScratch(Size conflictsCount, LinearAllocator *const *conflicts) {
+	for (Size i = 0; i < SCRATCH_ARENAS_COUNT; ++i) {
+		LinearAllocator *scratch = &scratches[i];
+		Boolean doesConflict = 0;
+		for (Size j = 0; j < conflictsCount && !doesConflict; ++j) doesConflict = conflicts[j] == scratch;
+		if (doesConflict) continue;
+		if (!scratch->address) {
+			scratch->reservation = SCRATCH_RESERVATION;
+			InitializeLinearAllocator(scratch);
+		}
+		return scratch;
+	}
+	Assert(!"conflicted", "every scratch arena conflicts. perhaps increase `SCRATCH_ARENAS_COUNT`?");
+	return 0;
+}
 
-	for (Size i = flagsCount - 1; i != 0; --i) {
-		Bits64 flags = flagsArray[i];
-		Size flagOffset = FindSetBit(flags);
-		...
+void ReleaseScratches(void) {
+	for (Size i = 0; i < SCRATCH_ARENAS_COUNT; ++i) {
+		LinearAllocator *scratch = &scratches[i];
+		if (!scratch->address) continue;
+		ReleaseVirtualMemory(scratch->address, scratch->reservation);
+		*scratch = (LinearAllocator){0};
 	}
+}
 
-for example:
+/* chained linear allocator ***************************************************/
 
-E - entry
-F - flags
-# - empty
+/* NOTE(Emhyr): each block begins with its header. the current block's header is
+only updated when another block becomes current */
+struct LinearBlock {
+	LinearBlock *previous;
+	Size         reservation;
+	Size         commission;
+	Size         extent;
+};
 
-to expand this:
-	[EEEEEEEEEEEEEEEEEEEEEEEE##############FFF]
-transform it to this:
-	[EEEEEEEEEEEEEEEEEEEEEEEEEEEEEEEE#####FFFF]
-*/
+typedef struct {
+	Address top;
+} ChainedFrameHeader;
+
+PRIVATE inline void InitializeChainedLinearAllocator(ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->reservation) allocator->reservation = DEFAULT_RESERVATION;
+	if (!context->reservation)   context->reservation   = allocator->reservation;
+	InitializeLinearAllocator(allocator);
+	LinearBlock *block = Push(sizeof(LinearBlock), ALIGNOF(LinearBlock), allocator);
+	block->previous = 0;
+}
 
-PRIVATE inline Size GaugeFlagsArraySize(Size quantity) {
-	return quantity / WIDTHOF(Bits64) * sizeof(Bits64);
+PRIVATE inline LinearBlock *GetCurrentBlock(ChainedLinearAllocator *context) {
+	return (LinearBlock *)context->allocator.address;
 }
 
-PRIVATE inline Bits64 *GetBeginningFlags(GranularAllocator *context) {
-	return (Bits64 *)(context->address + context->reservation - sizeof(Bits64));
+PRIVATE inline void SwitchBlock(LinearBlock *block, ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	LinearBlock *current = GetCurrentBlock(context);
+	current->reservation = allocator->reservation;
+	current->commission  = allocator->commission;
+	current->extent      = allocator->extent;
+	allocator->address     = (Address)block;
+	allocator->reservation = block->reservation;
+	allocator->commission  = block->commission;
+	allocator->extent      = block->extent;
 }
 
-PRIVATE inline Bits64 *GetEndingFlags(GranularAllocator *context) {
-	return (Bits64 *)((Address)GetBeginningFlags(context) - GaugeFlagsArraySize(context->quantity));
+/* NOTE(Emhyr): makes current an emptied block that fits the push, preferring a
+spare one */
+PRIVATE void ChainBlock(Size size, Size alignment, ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	Size granularity = QueryVirtualMemoryGranularity();
+	Size reservation = Maximum(context->reservation, AlignForwards(sizeof(LinearBlock) + alignment - 1 + size, granularity));
+	LinearBlock **link = &context->spares;
+	while (*link && (*link)->reservation < reservation) link = &(*link)->previous;
+	LinearBlock *block = *link;
+	if (block) *link = block->previous;
+	else {
+		Address address = ReserveVirtualMemory(reservation);
+		Size commission = AlignForwards(sizeof(LinearBlock), granularity);
+		CommitVirtualMemoryWithContext(allocator, address, commission);
+		block = (LinearBlock *)address;
+		block->reservation = reservation;
+		block->commission  = commission;
+	}
+	block->previous = GetCurrentBlock(context);
+	block->extent   = sizeof(LinearBlock);
+	SwitchBlock(block, context);
 }
 
-/* granular allocator / creation **********************************************/
+/* NOTE(Emhyr): makes current the previous block, and spares the current one */
+PRIVATE inline void UnchainBlock(ChainedLinearAllocator *context) {
+	LinearBlock *block = GetCurrentBlock(context);
+	SwitchBlock(block->previous, context);
+	block->previous = context->spares;
+	context->spares = block;
+}
 
-void InitializeGranularAllocator(GranularAllocator *context) {
-	if (!context->reservation) context->reservation = DEFAULT_RESERVATION;
-	if (!context->address)     context->address     = ReserveVirtualMemory(context->reservation);
-	if (!context->granularity) context->granularity = DEFAULT_GRANULARITY;
-	if (!context->quantity)    context->quantity    = DEFAULT_QUANTITY;
+/* NOTE(Emhyr): a top at the beginning of a block is the ending of the previous
+one, since every top within a block lies beyond its header */
+PRIVATE void UnchainBlocks(Address top, ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	while (top < allocator->address + sizeof(LinearBlock) || top > allocator->address + allocator->reservation) {
+		Assert(GetCurrentBlock(context)->previous, "underflowed! perhaps the frame isn't of this allocator?");
+		UnchainBlock(context);
+	}
+	allocator->extent = top - allocator->address;
+}
 
-	/* NOTE(Emhyr): we don't care if the granularity is an odd number here. should we? */
-	/* NOTE(Emhyr): should we align the quantity to correspond with the amount of bytes committed for the flags? */
+/* chained linear allocator / destruction *************************************/
 
-	Address ending = (Address)GetEndingFlags(context);
-	CommitVirtualMemory(AlignBackwards(ending + sizeof(Bits64), QueryVirtualMemoryGranularity()), GaugeFlagsArraySize(context->quantity));
-	
-	/* NOTE(Emhyr): we assume that the reservation is enough for the blocks here. this is unsafe */
+void ClearChainedLinearAllocator(ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) return;
+	while (GetCurrentBlock(context)->previous) UnchainBlock(context);
+	allocator->extent = sizeof(LinearBlock);
 }
 
-GranularAllocator CreateGranularAllocator(Size reservation, Size granularity, Size quantity) {
-	GranularAllocator result = {.reservation = reservation, .granularity = granularity, .quantity = quantity};
-	InitializeGranularAllocator(&result);
-	return result;
+void DestroyChainedLinearAllocator(ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) return;
+	ClearChainedLinearAllocator(context);
+	for (LinearBlock *block = context->spares; block;) {
+		LinearBlock *previous = block->previous;
+		ReleaseVirtualMemory((Address)block, block->reservation);
+		block = previous;
+	}
+	ReleaseVirtualMemory(allocator->address, allocator->reservation);
+	context->spares = 0;
+	allocator->address = 0;
+	allocator->commission = 0;
+	allocator->extent = 0;
 }
 
-/* granular allocator / destruction *******************************************/
+/* chained linear allocator / allocation **************************************/
+
+PRIVATE inline void *DoPushChained(Boolean doZero, Size size, Size alignment, ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) InitializeChainedLinearAllocator(context);
+	void *result = doZero ? PushZeroed(size, alignment, allocator) : Push(size, alignment, allocator);
+	if (!result) {
+		ChainBlock(size, alignment, context);
+		result = doZero ? PushZeroed(size, alignment, allocator) : Push(size, alignment, allocator);
+	}
+	return result;
+}
+
+void *PushChained(Size size, Size alignment, ChainedLinearAllocator *context) {
+	return DoPushChained(0, size, alignment, context);
+}
+
+void *PushChainedZeroed(Size size, Size alignment, ChainedLinearAllocator *context) {
+	return DoPushChained(1, size, alignment, context);
+}
+
+/* NOTE(Emhyr): the header stores the absolute address of the top, which
+identifies the block to pull back to. the allocation is over-pushed by the
+alignment since the block isn't known beforehand */
+void *PushFrameChained(Size size, Size alignment, ChainedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) InitializeChainedLinearAllocator(context);
+	Address top = allocator->address + allocator->extent;
+	alignment = Maximum(alignment, ALIGNOF(ChainedFrameHeader));
+	Address frame = (Address)PushChained(sizeof(ChainedFrameHeader) + alignment - 1 + size, ALIGNOF(ChainedFrameHeader), context);
+	if (!frame) return 0;
+	Address result = AlignForwards(frame + sizeof(ChainedFrameHeader), alignment);
+	((ChainedFrameHeader *)result)[-1].top = top;
+	return (void *)result;
+}
+
+void *PushFrameChainedZeroed(Size size, Size alignment, ChainedLinearAllocator *context) {
+	void *result = PushFrameChained(size, alignment, context);
+	if (result) Zero(result, size);
+	return result;
+}
+
+/* chained linear allocator / deallocation ************************************/
+
+void PullFrameChained(void *address, ChainedLinearAllocator *context) {
+	UnchainBlocks(((ChainedFrameHeader *)address)[-1].top, context);
+	Record(&context->allocator, pulls, 1);
+}
+
+/* shared linear allocator ****************************************************/
+
+/* NOTE(Emhyr): the allocator is initialized aside and its address is published
+last, since the threads that see the address don't take the lock */
+PRIVATE inline void InitializeSharedLinearAllocator(SharedLinearAllocator *context) {
+	if (AtomicLoad(&context->allocator.address)) return;
+	AcquireLock(&context->lock);
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) {
+		LinearAllocator result = {
+			.reservation = allocator->reservation,
+			.factor      = allocator->factor,
+			.commission  = allocator->commission,
+			.affinity    = allocator->affinity,
+		};
+		InitializeLinearAllocator(&result);
+		allocator->reservation = result.reservation;
+		allocator->factor      = result.factor;
+		allocator->commission  = result.commission;
+#if ENABLE_STATISTICS
+		Record(allocator, commits,   result.statistics.commits);
+		Record(allocator, committed, result.statistics.committed);
+#endif
+		AtomicStore(&allocator->address, result.address);
+	}
+	ReleaseLock(&context->lock);
+}
+
+/* NOTE(Emhyr): commits until the commission covers `extent`. threads that
+don't get the lock wait for the one that does, which may be in a syscall */
+PRIVATE void CommitShared(Size extent, SharedLinearAllocator *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if ((Size)AtomicLoad(&allocator->commission) >= extent) return;
+	AcquireLock(&context->lock);
+	Size commission = allocator->commission;
+	if (commission < extent) {
+		Size newCommission = GaugeCommission(extent, allocator);
+		CommitVirtualMemoryWithContext(allocator, allocator->address + commission, newCommission - commission);
+		AtomicStore(&allocator->commission, newCommission);
+	}
+	ReleaseLock(&context->lock);
+}
+
+/* shared linear allocator / allocation ***************************************/
+
+/* NOTE(Emhyr): the alignment is accounted for by claiming `alignment - 1`
+superfluous addresses, since we can't know the extent before claiming. a claim
+that'd exceed the reservation isn't made, so the extent never passes it */
+
+void *PushShared(Size size, Size alignment, SharedLinearAllocator *context) {
+#if ENABLE_AUTOMATIC_INITIALIZATION
+	InitializeSharedLinearAllocator(context);
+#endif
+
+	LinearAllocator *allocator = &context->allocator;
+	if (size > allocator->reservation || alignment - 1 > allocator->reservation - size) return 0;
+	Size claim = size + alignment - 1;
+	Size extent = AtomicLoad(&allocator->extent);
+	do {
+		if (claim > allocator->reservation - extent) return 0;
+	} while (!AtomicCompareExchange(&allocator->extent, &extent, extent + claim));
+	CommitShared(extent + claim, context);
+	RecordAtomically(allocator, pushes, 1);
+	return (void *)AlignForwards(allocator->address + extent, alignment);
+}
+
+void *PushSharedZeroed(Size size, Size alignment, SharedLinearAllocator *context) {
+	void *result = PushShared(size, alignment, context);
+	if (result) Zero(result, size);
+	return result;
+}
+
+/* granular allocator *********************************************************/
+
+/*
+
+the flags actually tails the allocator's memory in reverse word order. this is
+to enable the ability to increase the amount of entries without moving any bytes,
+and also allowed
+
+"reverse word order" means that you can traverse the flags as follows:
+
+	for (Size i = flagsCount - 1; i != 0; --i) {
+		Bits64 flags = flagsArray[i];
+		Size flagOffset = FindSetBit(flags);
+		...
+	}
+
+for example:
+
+E - entry
+F - flags
+# - empty
+
+to expand this:
+	[EEEEEEEEEEEEEEEEEEEEEEEE##############FFF]
+transform it to this:
+	[EEEEEEEEEEEEEEEEEEEEEEEEEEEEEEEE#####FFFF]
+*/
+
+PRIVATE inline Size GaugeFlagsArraySize(Size quantity) {
+	return quantity / WIDTHOF(Bits64) * sizeof(Bits64);
+}
+
+/*
+
+the summary tails the flags, and indexes them by word in forward order. it's
+laid out for the capacity, so that it never moves, while the flags beneath it
+grow with the quantity:
+
+	[EEEEEEEEEEEEEEEE##############FFFF|HHHH|1|2|R]
+
+H - hints: the longest clear run within each flags word
+1 - saturations: a set bit for each flags word that's full
+2 - saturations: a set bit for each saturations word of the first level that's full
+R - reaches: the longest reach of each flags word of a saturations word of the
+    first level, where a word's reach is its hint, or the run that's clear from
+    its most significant bit into the next word if that's longer, up to a word
+
+the saturations let `Put` skip full words in O(log n), and the hints let it
+check whether a run fits within a word in O(1). the reaches let it skip regions
+of 64 words that can't fit a run, whether or not they're full. the bits beyond
+the last word of each level are set so that they're never found.
+
+the reaches are only raised as flags are cleared, so they may overestimate. a
+search that passes through a whole region without finding a run lowers its
+reach to what it saw.
+
+each part of the summary begins at a page, so that each part's pages are
+committed as it grows.
+*/
+
+PRIVATE inline Size GaugeSaturationsCount(Size count) {
+	return (count + WIDTHOF(Bits64) - 1) / WIDTHOF(Bits64);
+}
+
+PRIVATE inline Size GaugeSummarySize(Size quantity) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Size words = quantity / WIDTHOF(Bits64);
+	Size saturations1 = GaugeSaturationsCount(words);
+	Size saturations2 = GaugeSaturationsCount(saturations1);
+	return AlignForwards(words, pageSize) + AlignForwards(saturations1 * sizeof(Bits64), pageSize) + AlignForwards(saturations2 * sizeof(Bits64), pageSize) + AlignForwards(saturations1, pageSize);
+}
+
+PRIVATE inline Address GetSummary(GranularAllocator *context) {
+	return context->address + context->reservation - GaugeSummarySize(context->capacity);
+}
+
+PRIVATE inline Bits64 *GetFlags(Size word, GranularAllocator *context) {
+	return (Bits64 *)GetSummary(context) - 1 - word;
+}
+
+PRIVATE inline Bits64 *GetSaturations(Size level, GranularAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Size count = context->capacity / WIDTHOF(Bits64);
+	Address result = GetSummary(context) + AlignForwards(count, pageSize);
+	for (Size i = 0; i < level; ++i) {
+		count = GaugeSaturationsCount(count);
+		result += AlignForwards(count * sizeof(Bits64), pageSize);
+	}
+	return (Bits64 *)result;
+}
+
+/* NOTE(Emhyr): the blocks, the flags and the summary, paged */
+PRIVATE inline Size GaugeGranularFootprint(Size quantity, Size granularity) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	return AlignForwards(quantity * granularity, pageSize) + AlignForwards(GaugeFlagsArraySize(quantity), pageSize) + GaugeSummarySize(quantity);
+}
+
+/* NOTE(Emhyr): a granule costs little more than its granularity, so that's the
+estimate to back off from */
+PRIVATE Size GaugeGranularCapacity(GranularAllocator *context) {
+	Size result = AlignBackwards(context->reservation / (context->granularity + 1), WIDTHOF(Bits64));
+	while (result && GaugeGranularFootprint(result, context->granularity) > context->reservation) result -= WIDTHOF(Bits64);
+	return result;
+}
+
+PRIVATE inline U8 *GetHints(GranularAllocator *context) {
+	return (U8 *)GetSummary(context);
+}
+
+/* NOTE(Emhyr): the reaches follow the last level of the saturations */
+PRIVATE inline U8 *GetReaches(GranularAllocator *context) {
+	return (U8 *)GetSaturations(2, context);
+}
+
+PRIVATE inline Size GaugeLongestClearRun(Bits64 x) {
+	Size result = 0;
+	Bits64 y = ~x;
+	while (y) {
+		y >>= BitScanForward(y);
+		Size run = ~y ? BitScanForward(~y) : WIDTHOF(y);
+		if (run > result) result = run;
+		if (run == WIDTHOF(y)) break;
+		y >>= run;
+	}
+	return result;
+}
+
+/* NOTE(Emhyr): assumes there's a clear run of `n` bits within `x` */
+PRIVATE inline Size FindClearRunWithinWord(Size n, Bits64 x) {
+	Bits64 y = ~x;
+	for (Size s = 1; s < n;) {
+		Size step = n - s < s ? n - s : s;
+		y &= y >> step;
+		s += step;
+	}
+	return BitScanForward(y);
+}
+
+PRIVATE inline void SetSaturationBit(Size index, Boolean saturated, Bits64 *saturations) {
+	Bits64 m = (Bits64)1 << index % WIDTHOF(Bits64);
+	if (saturated) saturations[index / WIDTHOF(Bits64)] |= m;
+	else saturations[index / WIDTHOF(Bits64)] &= ~m;
+}
+
+PRIVATE inline Size GaugeReach(Size word, GranularAllocator *context) {
+	Bits64 x = *GetFlags(word, context);
+	Size result = GetHints(context)[word];
+	if (!x || word + 1 >= context->quantity / WIDTHOF(Bits64)) return result;
+	Bits64 y = *GetFlags(word + 1, context);
+	Size run = WIDTHOF(x) - 1 - BitScanReverse(x) + (y ? BitScanForward(y) : WIDTHOF(y));
+	return Maximum(result, Minimum(run, WIDTHOF(x)));
+}
+
+/* NOTE(Emhyr): the word before `firstWord` reaches into it, so it's raised too */
+PRIVATE void RaiseReaches(Size firstWord, Size lastWord, GranularAllocator *context) {
+	U8 *reaches = GetReaches(context);
+	for (Size i = firstWord ? firstWord - 1 : 0; i <= lastWord; ++i) {
+		Size reach = GaugeReach(i, context);
+		if (reaches[i / WIDTHOF(Bits64)] < reach) reaches[i / WIDTHOF(Bits64)] = (U8)reach;
+	}
+}
+
+PRIVATE void UpdateSummary(Size firstWord, Size lastWord, GranularAllocator *context) {
+	Bits64 *saturations1 = GetSaturations(0, context);
+	Bits64 *saturations2 = GetSaturations(1, context);
+	U8 *hints = GetHints(context);
+	for (Size i = firstWord; i <= lastWord; ++i) {
+		Bits64 x = *GetFlags(i, context);
+		hints[i] = (U8)GaugeLongestClearRun(x);
+		SetSaturationBit(i, x == (Bits64)-1, saturations1);
+	}
+	for (Size i = firstWord / WIDTHOF(Bits64); i <= lastWord / WIDTHOF(Bits64); ++i)
+		SetSaturationBit(i, saturations1[i] == (Bits64)-1, saturations2);
+}
+
+/* NOTE(Emhyr): clears the flags words from `first` until `ending` in bulk, and
+their summary. the saturations words must already exist */
+PRIVATE void ClearFlagsWords(Size first, Size ending, GranularAllocator *context) {
+	if (first == ending) return;
+	Bits64 *saturations1 = GetSaturations(0, context);
+	Bits64 *saturations2 = GetSaturations(1, context);
+	Zero(GetFlags(ending - 1, context), (ending - first) * sizeof(Bits64));
+	Fill(GetHints(context) + first, WIDTHOF(Bits64), ending - first);
+	Size firstRegion = (first ? first - 1 : 0) / WIDTHOF(Bits64);
+	Fill(GetReaches(context) + firstRegion, WIDTHOF(Bits64), GaugeSaturationsCount(ending) - firstRegion);
+	BitLocation location = {saturations1 + first / WIDTHOF(Bits64), first % WIDTHOF(Bits64)};
+	SetBits(ending - first, location, 1, 0);
+	for (Size i = first / WIDTHOF(Bits64); i < GaugeSaturationsCount(ending); ++i)
+		SetSaturationBit(i, saturations1[i] == (Bits64)-1, saturations2);
+}
+
+/* NOTE(Emhyr): commits the pages that a region growing forwards from
+`beginning` grows into */
+PRIVATE inline void CommitForwards(Address beginning, Size size, Size newSize, GranularAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Address ending = AlignForwards(beginning + size, pageSize);
+	Address newEnding = AlignForwards(beginning + newSize, pageSize);
+	if (newEnding > ending) CommitVirtualMemoryWithContext(context, ending, newEnding - ending);
+}
+
+PRIVATE inline void CommitBackwards(Address ending, Size size, Size newSize, GranularAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Address beginning = AlignBackwards(ending - size, pageSize);
+	Address newBeginning = AlignBackwards(ending - newSize, pageSize);
+	if (newBeginning < beginning) CommitVirtualMemoryWithContext(context, newBeginning, beginning - newBeginning);
+}
+
+/* NOTE(Emhyr): the new granules are clear. the new saturations words are set,
+then the bits of the new flags words are cleared */
+PRIVATE void GrowGranularAllocator(Size quantity, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	Size newWords = quantity / WIDTHOF(Bits64);
+	Size saturations1Count = GaugeSaturationsCount(words);
+	Size newSaturations1Count = GaugeSaturationsCount(newWords);
+	Size saturations2Count = GaugeSaturationsCount(saturations1Count);
+	Size newSaturations2Count = GaugeSaturationsCount(newSaturations1Count);
+	Address hints = (Address)GetHints(context);
+	Bits64 *saturations1 = GetSaturations(0, context);
+	Bits64 *saturations2 = GetSaturations(1, context);
+	Address reaches = (Address)GetReaches(context);
+
+	CommitForwards(context->address, context->quantity * context->granularity, quantity * context->granularity, context);
+	CommitBackwards(GetSummary(context), GaugeFlagsArraySize(context->quantity), GaugeFlagsArraySize(quantity), context);
+	CommitForwards(hints, words, newWords, context);
+	CommitForwards((Address)saturations1, saturations1Count * sizeof(Bits64), newSaturations1Count * sizeof(Bits64), context);
+	CommitForwards((Address)saturations2, saturations2Count * sizeof(Bits64), newSaturations2Count * sizeof(Bits64), context);
+	CommitForwards(reaches, saturations1Count, newSaturations1Count, context);
+
+	Fill(saturations1 + saturations1Count, 0xFF, (newSaturations1Count - saturations1Count) * sizeof(Bits64));
+	Fill(saturations2 + saturations2Count, 0xFF, (newSaturations2Count - saturations2Count) * sizeof(Bits64));
+	ClearFlagsWords(words, newWords, context);
+	context->quantity = quantity;
+}
+
+/* NOTE(Emhyr): grows by at least double, and by at least enough for `count`
+granules past the quantity. returns whether it grew */
+PRIVATE Boolean GrowGranularAllocatorFor(Size count, GranularAllocator *context) {
+	if (context->quantity >= context->capacity) return 0;
+	Size quantity = Maximum(context->quantity * 2, AlignForwards(context->quantity + count, WIDTHOF(Bits64)));
+	GrowGranularAllocator(Minimum(quantity, context->capacity), context);
+	return 1;
+}
+
+/* NOTE(Emhyr): returns the index of the first flags word from `word` that isn't full */
+PRIVATE Size FindUnsaturatedWord(Size word, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	if (word >= words) return words;
+	Bits64 *saturations1 = GetSaturations(0, context);
+	Bits64 *saturations2 = GetSaturations(1, context);
+	Size i = word / WIDTHOF(Bits64);
+	Bits64 x = ~saturations1[i] & (Bits64)-1 << word % WIDTHOF(Bits64);
+	if (x) return i * WIDTHOF(Bits64) + BitScanForward(x);
+
+	++i;
+	Size j = i / WIDTHOF(Bits64);
+	Size saturations2Count = GaugeSaturationsCount(GaugeSaturationsCount(words));
+	if (j >= saturations2Count) return words;
+	x = ~saturations2[j] & (Bits64)-1 << i % WIDTHOF(Bits64);
+	if (x) i = j * WIDTHOF(Bits64) + BitScanForward(x);
+	else {
+		BitLocation location = FindBit(saturations2 + j + 1, saturations2 + saturations2Count, 1);
+		if (!location.pointer) return words;
+		i = (location.pointer - saturations2) * WIDTHOF(Bits64) + location.index;
+	}
+	return i * WIDTHOF(Bits64) + BitScanForward(~saturations1[i]);
+}
+
+/* NOTE(Emhyr): runs may span multiple words, but they begin within the words
+from `first` until `ending`. returns `quantity` if there's no run of `n` clear
+flags.
+
+a run that's longer than a word reaches a word's width, so the regions that
+reach less than `n`, or a word, are skipped. a region's reach is lowered once
+it's searched from its first word to its last, which a run that's longer than a
+word can't promise, since it's searched across words at once */
+PRIVATE Size FindClearRun(Size n, Size first, Size ending, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	Bits64 *flags = GetFlags(0, context);
+	U8 *hints = GetHints(context);
+	U8 *reaches = GetReaches(context);
+	Size least = Minimum(n, WIDTHOF(Bits64));
+	Size region = words;
+	Boolean lowering = 0;
+	Size reach = 0;
+	Size i = first;
+	for (;;) {
+		if (i < ending && !hints[i]) i = FindUnsaturatedWord(i, context);
+		if (i >= ending) break;
+		if (i / WIDTHOF(Bits64) != region) {
+			if (lowering) reaches[region] = (U8)reach;
+			region = i / WIDTHOF(Bits64);
+			if (reaches[region] < least) {
+				lowering = 0;
+				i = (region + 1) * WIDTHOF(Bits64);
+				continue;
+			}
+			lowering = n <= WIDTHOF(Bits64) && region * WIDTHOF(Bits64) >= first;
+			reach = 0;
+		}
+		Bits64 x = *(flags - i);
+		if (n <= hints[i]) return i * WIDTHOF(x) + FindClearRunWithinWord(n, x);
+
+		/* NOTE(Emhyr): try the run that's clear to the most significant bit */
+		Size word = i;
+		Size run = WIDTHOF(x) - 1 - BitScanReverse(x);
+		Size beginning = (i + 1) * WIDTHOF(x) - run;
+		for (++i; i < words; ++i) {
+			x = *(flags - i);
+			run += x ? BitScanForward(x) : WIDTHOF(x);
+			if (run >= n) return beginning;
+			if (x) break;
+		}
+
+		/* NOTE(Emhyr): the run is this word's reach if it's lowering, since
+		it's shorter than `n`, which doesn't exceed a word */
+		if (lowering) reach = Maximum(reach, Maximum((Size)hints[word], run));
+	}
+	if (lowering && ending == words) reaches[region] = (U8)reach;
+	return context->quantity;
+}
+
+/* NOTE(Emhyr): like `GaugeLongestClearRun`, but for the smallest run of at
+least `n` bits. assumes there's one */
+PRIVATE inline Size FindBestClearRunWithinWord(Size n, Bits64 x) {
+	Size result = 0, best = WIDTHOF(x) + 1, offset = 0;
+	Bits64 y = ~x;
+	while (y) {
+		Size skip = BitScanForward(y);
+		y >>= skip;
+		offset += skip;
+		Size run = ~y ? BitScanForward(~y) : WIDTHOF(y);
+		if (run >= n && run < best) {
+			result = offset;
+			best = run;
+			if (run == n) break;
+		}
+		if (run == WIDTHOF(y)) break;
+		y >>= run;
+		offset += run;
+	}
+	return result;
+}
+
+/* NOTE(Emhyr): the words are compared by their hints, which are their longest
+runs. runs that don't fit within a word are first-fit */
+PRIVATE Size FindBestClearRun(Size n, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	if (n > WIDTHOF(Bits64)) return FindClearRun(n, 0, words, context);
+	U8 *hints = GetHints(context);
+	Size best = words, probes = 0;
+	for (Size i = FindUnsaturatedWord(0, context); i < words && probes < BEST_FIT_PROBES; i = FindUnsaturatedWord(i + 1, context)) {
+		if (hints[i] < n) continue;
+		++probes;
+		if (best == words || hints[i] < hints[best]) best = i;
+		if (hints[best] == n) break;
+	}
+	if (best == words) return FindClearRun(n, 0, words, context);
+	return best * WIDTHOF(Bits64) + FindBestClearRunWithinWord(n, *GetFlags(best, context));
+}
+
+PRIVATE Size FindPlacement(Size n, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	Size result;
+	switch (context->placement) {
+	case PLACEMENT_NEXT_FIT: {
+		Size cursor = context->cursor / WIDTHOF(Bits64);
+		if (cursor >= words) cursor = 0;
+		result = FindClearRun(n, cursor, words, context);
+		if (result == context->quantity && cursor) result = FindClearRun(n, 0, cursor, context);
+		break;
+	}
+	case PLACEMENT_BEST_FIT:
+		result = FindBestClearRun(n, context);
+		break;
+	default:
+		result = FindClearRun(n, 0, words, context);
+		break;
+	}
+	return result;
+}
+
+PRIVATE void SetFlags(Size index, Size count, Boolean clear, GranularAllocator *context) {
+	BitLocation location = {
+		.pointer = GetFlags(index / WIDTHOF(Bits64), context),
+		.index = index % WIDTHOF(Bits64)
+	};
+	SetBits(count, location, clear, 1);
+	UpdateSummary(index / WIDTHOF(Bits64), (index + count - 1) / WIDTHOF(Bits64), context);
+	if (clear) RaiseReaches(index / WIDTHOF(Bits64), (index + count - 1) / WIDTHOF(Bits64), context);
+}
+
+/* granular allocator / creation **********************************************/
+
+/* NOTE(Emhyr): the summary and the flags tail the reservation, and they're
+committed by pages, so the reservation's end must be at a page */
+void InitializeGranularAllocator(GranularAllocator *context) {
+	if (!context->reservation) context->reservation = DEFAULT_RESERVATION;
+	context->reservation = AlignBackwards(context->reservation, QueryVirtualMemoryGranularity());
+	if (!context->address)     context->address     = ReserveVirtualMemory(context->reservation);
+	Assert(!GaugeBackwardAligner(context->address, QueryVirtualMemoryGranularity()), "the address isn't at a page");
+	if (!context->granularity) context->granularity = DEFAULT_GRANULARITY;
+	if (!context->quantity)    context->quantity    = DEFAULT_QUANTITY;
+
+	/* NOTE(Emhyr): we don't care if the granularity is an odd number here. should we? */
+
+	if (!context->capacity)    context->capacity    = GaugeGranularCapacity(context);
+
+	Size quantity = AlignForwards(context->quantity, WIDTHOF(Bits64));
+	context->capacity = AlignBackwards(context->capacity, WIDTHOF(Bits64));
+	if (quantity > context->capacity) quantity = context->capacity;
+	Assert(quantity && GaugeGranularFootprint(context->capacity, context->granularity) <= context->reservation, "the reservation is too small for the blocks, the summary and the flags");
+	context->quantity = 0;
+	GrowGranularAllocator(quantity, context);
+}
+
+GranularAllocator CreateGranularAllocator(Size reservation, Size granularity, Size quantity) {
+	GranularAllocator result = {.reservation = reservation, .granularity = granularity, .quantity = quantity};
+	InitializeGranularAllocator(&result);
+	return result;
+}
+
+/* granular allocator / destruction *******************************************/
+
+void ClearGranularAllocator(GranularAllocator *context) {
+	if (!context->address) return;
+	ClearFlagsWords(0, context->quantity / WIDTHOF(Bits64), context);
+#if ENABLE_STATISTICS
+	context->statistics.liveGranules = 0;
+#endif
+}
 
-void ClearGranularAllocator(GranularAllocator *context) {
-	Assert(!"unimplemented");
-}
- 
 void ClearGranularAllocatorWaned(GranularAllocator *context) {
-	Assert(!"unimplemented");
+	if (!context->address) return;
+	ClearGranularAllocator(context);
+	ResetVirtualMemoryWithContext(context, context->address, AlignForwards(context->quantity * context->granularity, QueryVirtualMemoryGranularity()));
 }
 
 /* granular allocator / allocation ********************************************/
@@ -510,11 +1842,15 @@ void *Put(Size size, GranularAllocator *context) {
 #endif
 	
 	Size count = (size + context->granularity - 1) / context->granularity;
-	Bits64 *beginning = GetBeginningFlags(context);
-	BitLocation location = FindBits(count, beginning, GetEndingFlags(context), 1);
-	if (!location.pointer) return 0;
-	SetBits(count, location, 0, 1);
-	Size index = (beginning - location.pointer) * WIDTHOF(Bits64) + location.index;
+	Size index = FindPlacement(count, context);
+	while (index == context->quantity) {
+		if (!GrowGranularAllocatorFor(count, context)) return 0;
+		index = FindPlacement(count, context);
+	}
+	SetFlags(index, count, 0, context);
+	context->cursor = index + count;
+	Record(context, puts, 1);
+	Record(context, liveGranules, count);
 	void *result = (void *)(context->address + index * context->granularity);
 	return result;
 }
@@ -525,6 +1861,41 @@ void *PutZeroed(Size size, GranularAllocator *context) {
 	return result;
 }
 
+/* NOTE(Emhyr): a run grows in place if the flags after it are clear */
+void *Reput(void *address, Size size, Size newSize, GranularAllocator *context) {
+	Size count = (size + context->granularity - 1) / context->granularity;
+	Size newCount = (newSize + context->granularity - 1) / context->granularity;
+	Size index = ((Address)address - context->address) / context->granularity;
+	if (newCount <= count) {
+		if (newCount < count) {
+			SetFlags(index + newCount, count - newCount, 1, context);
+			Record(context, liveGranules, newCount - count);
+		}
+		return address;
+	}
+
+	Size next = index + count;
+	if (index + newCount > context->quantity) GrowGranularAllocatorFor(index + newCount - context->quantity, context);
+	if (index + newCount <= context->quantity) {
+		BitLocation location = {
+			.pointer = GetFlags(next / WIDTHOF(Bits64), context),
+			.index = next % WIDTHOF(Bits64)
+		};
+		if (CheckBits(newCount - count, location, 1, 1)) {
+			SetFlags(next, newCount - count, 0, context);
+			Record(context, liveGranules, newCount - count);
+			return address;
+		}
+	}
+
+	void *result = Put(newSize, context);
+	if (result) {
+		Copy(result, address, size);
+		Pop(address, size, context);
+	}
+	return result;
+}
+
 /* granular allocator / deallocation ******************************************/
 
 void Pop(void *address, Size size, GranularAllocator *context) {
@@ -532,15 +1903,581 @@ void Pop(void *address, Size size, GranularAllocator *context) {
 	
 	Size count = (size + context->granularity - 1) / context->granularity;
 	Size index = ((Address)address - context->address) / context->granularity;
-	
-	BitLocation location = {
-		.pointer = GetBeginningFlags(context) + index / WIDTHOF(Bits64),
-		.index = index % WIDTHOF(Bits64)
-	};
-	SetBits(count, location, 0, 1);
+	SetFlags(index, count, 1, context);
+	Record(context, pops, 1);
+	Record(context, liveGranules, -count);
 }
 
+/* NOTE(Emhyr): returns whether every granule that overlaps the page is clear.
+the blocks' pages beyond the quantity are clear */
+PRIVATE inline Boolean CheckClearPage(Address page, GranularAllocator *context) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Size first = (page - context->address) / context->granularity;
+	Size ending = Minimum((page + pageSize - context->address + context->granularity - 1) / context->granularity, context->quantity);
+	if (first >= ending) return 1;
+	BitLocation location = {GetFlags(first / WIDTHOF(Bits64), context), first % WIDTHOF(Bits64)};
+	return CheckBits(ending - first, location, 1, 1);
+}
 
+/* NOTE(Emhyr): only the pages at either end of the run may be shared with other
+runs, so only they are checked */
 void PopWaned(void *address, Size size, GranularAllocator *context) {
-	Assert(!"unimplemented");
+	Pop(address, size, context);
+	Size pageSize = QueryVirtualMemoryGranularity();
+	Size count = (size + context->granularity - 1) / context->granularity;
+	Address beginning = AlignBackwards((Address)address, pageSize);
+	Address ending = AlignForwards((Address)address + count * context->granularity, pageSize);
+	if (!CheckClearPage(beginning, context)) beginning += pageSize;
+	if (beginning < ending && !CheckClearPage(ending - pageSize, context)) ending -= pageSize;
+	if (beginning < ending) ResetVirtualMemoryWithContext(context, beginning, ending - beginning);
+}
+
+/* granular allocator / inspection ********************************************/
+
+void BeginGranularIteration(BitIterator *iterator, GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	BeginBitIteration(GetFlags(0, context), GetFlags(words, context), iterator);
+}
+
+/* shared granular allocator **************************************************/
+
+ASSERT(GRANULAR_MAGAZINE_CAPACITY >= 2, "the magazines can't be refilled or flushed by half");
+
+typedef struct {
+	SharedGranularAllocator *context;
+	Size                     counts[GRANULAR_CACHE_CLASSES];
+	void                    *rounds[GRANULAR_CACHE_CLASSES][GRANULAR_MAGAZINE_CAPACITY];
+} Magazines;
+
+PRIVATE THREADIC Magazines magazinesTable[GRANULAR_CACHE_SLOTS];
+
+PRIVATE inline Magazines *GetMagazines(SharedGranularAllocator *context) {
+	Magazines *vacancy = 0;
+	for (Size i = 0; i < GRANULAR_CACHE_SLOTS; ++i) {
+		if (magazinesTable[i].context == context) return &magazinesTable[i];
+		if (!vacancy && !magazinesTable[i].context) vacancy = &magazinesTable[i];
+	}
+	if (vacancy) vacancy->context = context;
+	return vacancy;
+}
+
+PRIVATE inline Size GaugeCacheClass(Size count) {
+	return count > 1 ? BitScanReverse(count - 1) + 1 : 0;
+}
+
+PRIVATE inline Size GaugeCacheClassSize(Size class, SharedGranularAllocator *context) {
+	return ((Size)1 << class) * context->allocator.granularity;
+}
+
+/* NOTE(Emhyr): the allocator is initialized aside and its address is published
+last, since the threads that see the address don't take the lock */
+PRIVATE inline void InitializeSharedGranularAllocator(SharedGranularAllocator *context) {
+	if (AtomicLoad(&context->allocator.address)) return;
+	AcquireLock(&context->lock);
+	GranularAllocator *allocator = &context->allocator;
+	if (!allocator->address) {
+		GranularAllocator result = {
+			.reservation = allocator->reservation,
+			.granularity = allocator->granularity,
+			.quantity    = allocator->quantity,
+			.capacity    = allocator->capacity,
+			.placement   = allocator->placement,
+			.affinity    = allocator->affinity,
+		};
+		InitializeGranularAllocator(&result);
+		allocator->reservation = result.reservation;
+		allocator->granularity = result.granularity;
+		allocator->quantity    = result.quantity;
+		allocator->capacity    = result.capacity;
+#if ENABLE_STATISTICS
+		Record(allocator, commits,   result.statistics.commits);
+		Record(allocator, committed, result.statistics.committed);
+#endif
+		AtomicStore(&allocator->address, result.address);
+	}
+	ReleaseLock(&context->lock);
+}
+
+PRIVATE void RefillRounds(void **rounds, Size *count, Size size, SharedGranularAllocator *context) {
+	Size n = *count;
+	AcquireLock(&context->lock);
+	while (n < GRANULAR_MAGAZINE_CAPACITY / 2) {
+		void *round = Put(size, &context->allocator);
+		if (!round) break;
+		rounds[n++] = round;
+	}
+	ReleaseLock(&context->lock);
+	*count = n;
+}
+
+PRIVATE void FlushRounds(void **rounds, Size *count, Size remainder, Size size, SharedGranularAllocator *context) {
+	Size n = *count;
+	AcquireLock(&context->lock);
+	while (n > remainder) Pop(rounds[--n], size, &context->allocator);
+	ReleaseLock(&context->lock);
+	*count = n;
+}
+
+PRIVATE inline void RefillMagazine(Size class, Magazines *magazines) {
+	SharedGranularAllocator *context = magazines->context;
+	RefillRounds(magazines->rounds[class], &magazines->counts[class], GaugeCacheClassSize(class, context), context);
+}
+
+PRIVATE inline void FlushMagazine(Size class, Size remainder, Magazines *magazines) {
+	SharedGranularAllocator *context = magazines->context;
+	FlushRounds(magazines->rounds[class], &magazines->counts[class], remainder, GaugeCacheClassSize(class, context), context);
+}
+
+/* shared granular allocator / allocation *************************************/
+
+void *PutCached(Size size, SharedGranularAllocator *context) {
+#if ENABLE_AUTOMATIC_INITIALIZATION
+	InitializeSharedGranularAllocator(context);
+#endif
+
+	void *result;
+	Size count = (size + context->allocator.granularity - 1) / context->allocator.granularity;
+	Size class = GaugeCacheClass(count);
+	Magazines *magazines = 0;
+	if (class < GRANULAR_CACHE_CLASSES) {
+		/* NOTE(Emhyr): cached sizes are rounded to their classes' sizes, even
+		without magazines, so a block's pop matches its put wherever it goes */
+		size = GaugeCacheClassSize(class, context);
+		magazines = GetMagazines(context);
+	}
+	if (!magazines) {
+		AcquireLock(&context->lock);
+		result = Put(size, &context->allocator);
+		ReleaseLock(&context->lock);
+		return result;
+	}
+	if (!magazines->counts[class]) RefillMagazine(class, magazines);
+	if (!magazines->counts[class]) return 0;
+	result = magazines->rounds[class][--magazines->counts[class]];
+	return result;
+}
+
+void *PutCachedZeroed(Size size, SharedGranularAllocator *context) {
+	void *result = PutCached(size, context);
+	if (result) Zero(result, size);
+	return result;
+}
+
+/* shared granular allocator / deallocation ***********************************/
+
+void PopCached(void *address, Size size, SharedGranularAllocator *context) {
+	Size count = (size + context->allocator.granularity - 1) / context->allocator.granularity;
+	Size class = GaugeCacheClass(count);
+	Magazines *magazines = 0;
+	if (class < GRANULAR_CACHE_CLASSES) {
+		size = GaugeCacheClassSize(class, context);
+		magazines = GetMagazines(context);
+	}
+	if (!magazines) {
+		AcquireLock(&context->lock);
+		Pop(address, size, &context->allocator);
+		ReleaseLock(&context->lock);
+		return;
+	}
+	if (magazines->counts[class] == GRANULAR_MAGAZINE_CAPACITY) FlushMagazine(class, GRANULAR_MAGAZINE_CAPACITY / 2, magazines);
+	magazines->rounds[class][magazines->counts[class]++] = address;
+}
+
+void FlushCaches(SharedGranularAllocator *context) {
+	for (Size i = 0; i < GRANULAR_CACHE_SLOTS; ++i) {
+		Magazines *magazines = &magazinesTable[i];
+		if (magazines->context != context) continue;
+		for (Size class = 0; class < GRANULAR_CACHE_CLASSES; ++class)
+			if (magazines->counts[class]) FlushMagazine(class, 0, magazines);
+		magazines->context = 0;
+	}
+}
+
+/* segregated allocator *******************************************************/
+
+#define SEGREGATED_MINIMUM_ALIGNMENT 16
+
+typedef struct {
+	Address mapping;
+	Size    reservation;
+	Size    size;
+} LargeBlockHeader;
+
+typedef struct {
+	SegregatedAllocator *context;
+	Size                 counts[SEGREGATED_CLASSES_COUNT];
+	void                *rounds[SEGREGATED_CLASSES_COUNT][GRANULAR_MAGAZINE_CAPACITY];
+} SegregatedMagazines;
+
+PRIVATE THREADIC SegregatedMagazines segregatedMagazines;
+
+PRIVATE inline Size GaugeSegregatedClass(Size size) {
+	if (size <= 128) return size ? (size - 1) / 16 : 0;
+	Size k = BitScanReverse(size - 1);
+	return 8 + (k - 7) * 4 + ((size - 1) >> (k - 2)) - 4;
+}
+
+PRIVATE inline Size GaugeSegregatedClassSize(Size class) {
+	if (class < 8) return (class + 1) * 16;
+	Size k = (class - 8) / 4 + 7;
+	return ((Size)1 << k) + ((class - 8) % 4 + 1) * ((Size)1 << (k - 2));
+}
+
+/* NOTE(Emhyr): every granule is a block, and the capacity is whatever fits the
+class's reservation. the quantity grows from the default on demand */
+PRIVATE void InitializeSegregatedClass(Size class, SegregatedAllocator *context) {
+	SharedGranularAllocator *allocator = &context->classes[class];
+	if (AtomicLoad(&allocator->allocator.address)) return;
+	AcquireLock(&allocator->lock);
+	if (!allocator->allocator.address) {
+		GranularAllocator result = {
+			.reservation = SEGREGATED_CLASS_RESERVATION,
+			.address     = context->address + (Address)(class * SEGREGATED_CLASS_RESERVATION),
+			.granularity = GaugeSegregatedClassSize(class),
+		};
+		InitializeGranularAllocator(&result);
+		allocator->allocator.reservation = result.reservation;
+		allocator->allocator.granularity = result.granularity;
+		allocator->allocator.quantity    = result.quantity;
+		allocator->allocator.capacity    = result.capacity;
+		AtomicStore(&allocator->allocator.address, result.address);
+	}
+	ReleaseLock(&allocator->lock);
+}
+
+PRIVATE inline Size GaugeSegregatedReservation(void) {
+	return (Size)SEGREGATED_CLASSES_COUNT * SEGREGATED_CLASS_RESERVATION;
+}
+
+PRIVATE inline Boolean CheckSegregatedAddress(Address address, SegregatedAllocator *context) {
+	return address >= context->address && address < context->address + (Address)GaugeSegregatedReservation();
+}
+
+PRIVATE inline LargeBlockHeader *GetLargeBlockHeader(Address address) {
+	return (LargeBlockHeader *)address - 1;
+}
+
+/* NOTE(Emhyr): sizes and alignments of half the address space are rejected,
+so that the reservation can't overflow */
+PRIVATE void *AllocateLarge(Size size, Size alignment) {
+	if (size >= (Size)-1 / 2 || alignment >= (Size)-1 / 2) return 0;
+	Size reservation = AlignForwards(sizeof(LargeBlockHeader) + alignment + size, QueryVirtualMemoryGranularity());
+	Address mapping = TryAllocateVirtualMemory(reservation);
+	if (!mapping) return 0;
+	Address result = AlignForwards(mapping + sizeof(LargeBlockHeader), alignment);
+	LargeBlockHeader *header = GetLargeBlockHeader(result);
+	header->mapping = mapping;
+	header->reservation = reservation;
+	header->size = mapping + reservation - result;
+	return (void *)result;
 }
+
+PRIVATE inline Size GaugeSegregatedBlockSize(Address address, SegregatedAllocator *context) {
+	if (CheckSegregatedAddress(address, context))
+		return GaugeSegregatedClassSize((address - context->address) / SEGREGATED_CLASS_RESERVATION);
+	return GetLargeBlockHeader(address)->size;
+}
+
+/* NOTE(Emhyr): each class begins at a page, so its blocks are aligned by the
+lesser of its size's largest power of 2 and the page's size. greater alignments
+are left to large blocks */
+PRIVATE inline Size FindSegregatedClass(Size size, Size alignment) {
+	if (alignment > QueryVirtualMemoryGranularity()) return SEGREGATED_CLASSES_COUNT;
+	for (Size class = GaugeSegregatedClass(size); class < SEGREGATED_CLASSES_COUNT; ++class)
+		if (!GaugeBackwardAligner(GaugeSegregatedClassSize(class), alignment)) return class;
+	return SEGREGATED_CLASSES_COUNT;
+}
+
+/* segregated allocator / creation ********************************************/
+
+void InitializeSegregatedAllocator(SegregatedAllocator *context) {
+	if (AtomicLoad(&context->address)) return;
+	AcquireLock(&context->lock);
+	if (!context->address) AtomicStore(&context->address, ReserveVirtualMemory(GaugeSegregatedReservation()));
+	ReleaseLock(&context->lock);
+}
+
+/* segregated allocator / allocation ******************************************/
+
+void *Allocate(Size size, Size alignment, SegregatedAllocator *context) {
+#if ENABLE_AUTOMATIC_INITIALIZATION
+	InitializeSegregatedAllocator(context);
+#endif
+
+	if (alignment < SEGREGATED_MINIMUM_ALIGNMENT) alignment = SEGREGATED_MINIMUM_ALIGNMENT;
+	Size class = FindSegregatedClass(size, alignment);
+	if (class == SEGREGATED_CLASSES_COUNT) return AllocateLarge(size, alignment);
+
+	InitializeSegregatedClass(class, context);
+	SharedGranularAllocator *allocator = &context->classes[class];
+	Size classSize = allocator->allocator.granularity;
+	SegregatedMagazines *magazines = &segregatedMagazines;
+	if (!magazines->context) magazines->context = context;
+	if (magazines->context != context) {
+		AcquireLock(&allocator->lock);
+		void *result = Put(classSize, &allocator->allocator);
+		ReleaseLock(&allocator->lock);
+		return result;
+	}
+	if (!magazines->counts[class]) RefillRounds(magazines->rounds[class], &magazines->counts[class], classSize, allocator);
+	if (!magazines->counts[class]) return 0;
+	return magazines->rounds[class][--magazines->counts[class]];
+}
+
+void *AllocateZeroed(Size size, Size alignment, SegregatedAllocator *context) {
+	void *result = Allocate(size, alignment, context);
+	/* NOTE(Emhyr): large blocks are freshly committed */
+	if (result && CheckSegregatedAddress((Address)result, context)) Zero(result, size);
+	return result;
+}
+
+void *Reallocate(void *address, Size size, Size alignment, SegregatedAllocator *context) {
+	if (!address) return Allocate(size, alignment, context);
+	Size blockSize = GaugeSegregatedBlockSize((Address)address, context);
+	if (size <= blockSize && size > blockSize / 2 && !GaugeBackwardAligner((Address)address, alignment ? alignment : 1)) return address;
+	void *result = Allocate(size, alignment, context);
+	if (result) {
+		Copy(result, address, size < blockSize ? size : blockSize);
+		Deallocate(address, context);
+	}
+	return result;
+}
+
+Size GaugeAllocation(void *address, SegregatedAllocator *context) {
+	return address ? GaugeSegregatedBlockSize((Address)address, context) : 0;
+}
+
+/* segregated allocator / deallocation ****************************************/
+
+void Deallocate(void *address, SegregatedAllocator *context) {
+	if (!address) return;
+	if (!CheckSegregatedAddress((Address)address, context)) {
+		LargeBlockHeader *header = GetLargeBlockHeader((Address)address);
+		ReleaseVirtualMemory(header->mapping, header->reservation);
+		return;
+	}
+	Size class = ((Address)address - context->address) / SEGREGATED_CLASS_RESERVATION;
+	SharedGranularAllocator *allocator = &context->classes[class];
+	Size classSize = allocator->allocator.granularity;
+	SegregatedMagazines *magazines = &segregatedMagazines;
+	if (!magazines->context) magazines->context = context;
+	if (magazines->context != context) {
+		AcquireLock(&allocator->lock);
+		Pop(address, classSize, &allocator->allocator);
+		ReleaseLock(&allocator->lock);
+		return;
+	}
+	if (magazines->counts[class] == GRANULAR_MAGAZINE_CAPACITY) FlushRounds(magazines->rounds[class], &magazines->counts[class], GRANULAR_MAGAZINE_CAPACITY / 2, classSize, allocator);
+	magazines->rounds[class][magazines->counts[class]++] = address;
+}
+
+void FlushSegregatedCaches(SegregatedAllocator *context) {
+	SegregatedMagazines *magazines = &segregatedMagazines;
+	if (magazines->context != context) return;
+	for (Size class = 0; class < SEGREGATED_CLASSES_COUNT; ++class)
+		if (magazines->counts[class]) FlushRounds(magazines->rounds[class], &magazines->counts[class], 0, context->classes[class].allocator.granularity, &context->classes[class]);
+	magazines->context = 0;
+}
+
+/* local allocators ***********************************************************/
+
+PRIVATE THREADIC struct {
+	Size node;
+	Size picks;
+} localNode;
+
+PRIVATE inline Size PickLocalNode(LocalAllocators *context) {
+	if (context->nodesCount == 1) return 0;
+	if (!localNode.picks--) {
+		localNode.node = QueryCurrentNode();
+		localNode.picks = LOCAL_NODE_PERIOD - 1;
+	}
+	return localNode.node % context->nodesCount;
+}
+
+/* local allocators / creation ************************************************/
+
+void InitializeLocalAllocators(LocalAllocators *context) {
+	context->nodesCount = Minimum(QueryNodesCount(), MAXIMUM_NODES_COUNT);
+	LinearAllocator *linear = &context->linears[0].allocator;
+	GranularAllocator *granular = &context->granulars[0].allocator;
+	Assert(!linear->address && !granular->address, "the allocators are already initialized");
+	for (Size node = 0; node < context->nodesCount; ++node) {
+		LinearAllocator *nodeLinear = &context->linears[node].allocator;
+		GranularAllocator *nodeGranular = &context->granulars[node].allocator;
+		if (node) {
+			*nodeLinear = (LinearAllocator){.reservation = linear->reservation, .factor = linear->factor, .commission = linear->commission};
+			*nodeGranular = (GranularAllocator){.reservation = granular->reservation, .granularity = granular->granularity, .quantity = granular->quantity, .capacity = granular->capacity, .placement = granular->placement};
+		}
+		if (context->nodesCount > 1) {
+			nodeLinear->affinity = NODE_AFFINITY(node);
+			nodeGranular->affinity = NODE_AFFINITY(node);
+		}
+		InitializeLinearAllocator(nodeLinear);
+		InitializeGranularAllocator(nodeGranular);
+	}
+}
+
+/* local allocators / allocation **********************************************/
+
+void *PushLocal(Size size, Size alignment, LocalAllocators *context) {
+	return PushShared(size, alignment, &context->linears[PickLocalNode(context)]);
+}
+
+void *PutLocal(Size size, LocalAllocators *context) {
+	return PutCached(size, &context->granulars[PickLocalNode(context)]);
+}
+
+/* local allocators / deallocation ********************************************/
+
+void PopLocal(void *address, Size size, LocalAllocators *context) {
+	for (Size node = 0; node < context->nodesCount; ++node) {
+		GranularAllocator *granular = &context->granulars[node].allocator;
+		if ((Size)((Address)address - granular->address) < granular->reservation) {
+			PopCached(address, size, &context->granulars[node]);
+			return;
+		}
+	}
+	Assert(0, "the address isn't any node's");
+}
+
+/* registry *******************************************************************/
+
+#if ENABLE_STATISTICS
+
+PRIVATE MemoryStatistics *registry;
+PRIVATE volatile Word registryLock;
+
+PRIVATE void Register(int kind, void *allocator, MemoryStatistics *statistics) {
+	AcquireLock(&registryLock);
+	statistics->kind = kind;
+	statistics->allocator = allocator;
+	statistics->previous = 0;
+	statistics->next = registry;
+	if (registry) registry->previous = statistics;
+	registry = statistics;
+	ReleaseLock(&registryLock);
+}
+
+PRIVATE void Unregister(MemoryStatistics *statistics) {
+	AcquireLock(&registryLock);
+	if (statistics->previous) statistics->previous->next = statistics->next;
+	else if (registry == statistics) registry = statistics->next;
+	if (statistics->next) statistics->next->previous = statistics->previous;
+	statistics->previous = statistics->next = 0;
+	ReleaseLock(&registryLock);
+}
+
+void RegisterLinearAllocator(LinearAllocator *context) {
+	Register(MEMORY_KIND_LINEAR, context, &context->statistics);
+}
+
+void UnregisterLinearAllocator(LinearAllocator *context) {
+	Unregister(&context->statistics);
+}
+
+void RegisterGranularAllocator(GranularAllocator *context) {
+	Register(MEMORY_KIND_GRANULAR, context, &context->statistics);
+}
+
+void UnregisterGranularAllocator(GranularAllocator *context) {
+	Unregister(&context->statistics);
+}
+
+/* NOTE(Emhyr): the runs within words are known by the hints, so only the runs
+across words are counted */
+PRIVATE Size GaugeLargestClearRun(GranularAllocator *context) {
+	Size words = context->quantity / WIDTHOF(Bits64);
+	U8 *hints = GetHints(context);
+	Size result = 0, run = 0;
+	for (Size i = 0; i < words; ++i) {
+		Bits64 x = *GetFlags(i, context);
+		if (!x) {
+			run += WIDTHOF(x);
+			continue;
+		}
+		run += BitScanForward(x);
+		result = Maximum(result, Maximum(run, (Size)hints[i]));
+		run = WIDTHOF(x) - 1 - BitScanReverse(x);
+	}
+	return Maximum(result, run);
+}
+
+void VisitAllocators(MemoryVisitor *visitor, void *user) {
+	AcquireLock(&registryLock);
+	for (MemoryStatistics *statistics = registry; statistics; statistics = statistics->next) {
+		MemoryReport report = {.kind = statistics->kind, .allocator = statistics->allocator, .statistics = *statistics};
+		if (statistics->kind == MEMORY_KIND_LINEAR) {
+			LinearAllocator *allocator = statistics->allocator;
+			report.reservation = allocator->reservation;
+			report.commission  = allocator->commission;
+			report.extent      = allocator->extent;
+		} else {
+			GranularAllocator *allocator = statistics->allocator;
+			report.reservation = allocator->reservation;
+			report.granularity = allocator->granularity;
+			report.quantity    = allocator->quantity;
+			report.largestRun  = allocator->address ? GaugeLargestClearRun(allocator) : allocator->quantity;
+		}
+		visitor(&report, user);
+	}
+	ReleaseLock(&registryLock);
+}
+
+typedef struct {
+	Byte *buffer;
+	Size  size;
+	Size  length;
+} Dump;
+
+PRIVATE void DumpText(const char *text, Dump *dump) {
+	for (; *text; ++text, ++dump->length)
+		if (dump->length < dump->size) dump->buffer[dump->length] = *text;
+}
+
+PRIVATE void DumpField(const char *name, Size value, Dump *dump) {
+	Byte digits[24];
+	Size i = sizeof(digits);
+	digits[--i] = 0;
+	do digits[--i] = '0' + value % 10;
+	while (value /= 10);
+	DumpText(" ", dump);
+	DumpText(name, dump);
+	DumpText("=", dump);
+	DumpText(digits + i, dump);
+}
+
+PRIVATE void DumpReport(const MemoryReport *report, void *user) {
+	Dump *dump = user;
+	const MemoryStatistics *statistics = &report->statistics;
+	DumpText(report->kind == MEMORY_KIND_LINEAR ? "linear" : "granular", dump);
+	DumpField("allocator", (Size)report->allocator, dump);
+	DumpField("reservation", report->reservation, dump);
+	DumpField("commits", statistics->commits, dump);
+	DumpField("committed", statistics->committed, dump);
+	DumpField("decommitted", statistics->decommitted, dump);
+	if (report->kind == MEMORY_KIND_LINEAR) {
+		DumpField("commission", report->commission, dump);
+		DumpField("extent", report->extent, dump);
+		DumpField("highestExtent", statistics->highestExtent, dump);
+		DumpField("pushes", statistics->pushes, dump);
+		DumpField("pulls", statistics->pulls, dump);
+	} else {
+		DumpField("granularity", report->granularity, dump);
+		DumpField("quantity", report->quantity, dump);
+		DumpField("liveGranules", statistics->liveGranules, dump);
+		DumpField("largestRun", report->largestRun, dump);
+		DumpField("puts", statistics->puts, dump);
+		DumpField("pops", statistics->pops, dump);
+	}
+	DumpText("\n", dump);
+}
+
+Size DumpAllocators(Byte *buffer, Size size) {
+	Dump dump = {buffer, size, 0};
+	VisitAllocators(DumpReport, &dump);
+	if (size) buffer[dump.length < size ? dump.length : size - 1] = 0;
+	return dump.length + 1;
+}
+
+#endif
@@ -35,14 +35,19 @@ their own memory.
 "put" - locks a block.
 "pop" - unlocks a block.
 
+"repush" - resizes the last push in place, or else pushes a copy.
+"reput"  - resizes a put in place, or else puts a copy and pops the original.
+
 "debug" - do checks and set traps.
-"wane"  - after allocating, decommit the next page from the extent's address.
+"wane"  - lowers the commission to the extent, decommitting the surplus. with a
+          waning policy, it's deferred to the reclaimer between watermarks.
 */
 
 #if !defined(INCLUDED_BASICS_MEMORY_H)
 #define INCLUDED_BASICS_MEMORY_H
 
 #include "basics_base.h"
+#include "basics_bits.h"
 
 /******************************************************************************/
 /* settings */
@@ -51,6 +56,12 @@ their own memory.
 #define ENABLE_STENOGRAPHY 1
 #endif
 
+/* adds statistics to the allocators and a registry to report them by. without
+it, the allocators' layouts and procedures are unchanged */
+#if !defined(ENABLE_STATISTICS)
+#define ENABLE_STATISTICS 0
+#endif
+
 /* when invoking an allocation procedure, the allocator is automatically
 initialized by setting zeroed fields to their defaults and preserving
 non-zeroed fields */
@@ -66,9 +77,27 @@ non-zeroed fields */
 /* the default factor used for initialization.
 
 a factor is used to multiply the commission upon an allocation. this's useful
-to reduce the amount of expensive commits */
+to reduce the amount of expensive commits, since the commission grows
+geometrically instead of by each allocation. it's capped by the reservation */
 #if !defined(DEFAULT_FACTOR)
-#define DEFAULT_FACTOR 1
+#define DEFAULT_FACTOR 2
+#endif
+
+/* the least amount of addresses committed at once upon an allocation */
+#if !defined(MINIMUM_COMMISSION)
+#define MINIMUM_COMMISSION 0x10000
+#endif
+
+/* the longest amount of milliseconds that the reclaimer of waning policies
+sleeps for */
+#if !defined(WANING_PERIOD)
+#define WANING_PERIOD 100
+#endif
+
+/* prefault the pages upon committing them, so that the first touches of an
+allocation don't fault */
+#if !defined(ENABLE_PREFAULTING)
+#define ENABLE_PREFAULTING 0
 #endif
 
 /* the default commission used for initialization */
@@ -81,14 +110,89 @@ to reduce the amount of expensive commits */
 #define DEFAULT_RESERVATION 0x40000000
 #endif
 
+/* the amount of scratch arenas per thread. a thread can hold as many scratch
+arenas at once as this, minus one */
+#if !defined(SCRATCH_ARENAS_COUNT)
+#define SCRATCH_ARENAS_COUNT 2
+#endif
+
+/* the reservation of each scratch arena */
+#if !defined(SCRATCH_RESERVATION)
+#define SCRATCH_RESERVATION DEFAULT_RESERVATION
+#endif
+
 /* the default granularity used for initialization */
 #if !defined(DEFAULT_GRANULARITY)
 #define DEFAULT_GRANULARITY 64
 #endif
 
-/* the default quantity used for initialization */
+/* the default quantity used for initialization. granular allocators grow from
+it on demand */
 #if !defined(DEFAULT_QUANTITY)
-#define DEFAULT_QUANTITY 32768
+#define DEFAULT_QUANTITY 4096
+#endif
+
+/* on unix, decommit with `MADV_FREE` instead of `MADV_DONTNEED`. it's cheaper,
+but recommitted pages aren't guaranteed to be zeroed */
+#if !defined(ENABLE_LAZY_DECOMMIT)
+#define ENABLE_LAZY_DECOMMIT 0
+#endif
+
+/* on unix, align reservations of at least `HUGE_PAGE_SIZE` bytes to
+`HUGE_PAGE_SIZE` and advise the system to back them with huge pages. this
+reduces TLB misses and commit faults for large allocators */
+#if !defined(ENABLE_HUGE_PAGES)
+#define ENABLE_HUGE_PAGES 0
+#endif
+
+#if !defined(HUGE_PAGE_SIZE)
+#define HUGE_PAGE_SIZE 0x200000
+#endif
+
+/* the most words with a fitting run that a best-fit put compares */
+#if !defined(BEST_FIT_PROBES)
+#define BEST_FIT_PROBES 16
+#endif
+
+/* the amount of shared granular allocators that each thread can cache for at
+once. the rest go through their locks */
+#if !defined(GRANULAR_CACHE_SLOTS)
+#define GRANULAR_CACHE_SLOTS 4
+#endif
+
+/* the amount of size classes cached by each thread. each class is twice the
+granules of the previous, starting at 1 */
+#if !defined(GRANULAR_CACHE_CLASSES)
+#define GRANULAR_CACHE_CLASSES 7
+#endif
+
+/* the amount of runs cached by each thread per size class. half of it is
+refilled or flushed at a time */
+#if !defined(GRANULAR_MAGAZINE_CAPACITY)
+#define GRANULAR_MAGAZINE_CAPACITY 32
+#endif
+
+/* the amount of size classes of a segregated allocator. the classes step by 16
+bytes up to 128 bytes, then by quarters of each power of 2. 40 classes reach
+32KiB, beyond which blocks are allocated directly from virtual memory */
+#if !defined(SEGREGATED_CLASSES_COUNT)
+#define SEGREGATED_CLASSES_COUNT 40
+#endif
+
+/* the reservation of each size class of a segregated allocator */
+#if !defined(SEGREGATED_CLASS_RESERVATION)
+#define SEGREGATED_CLASS_RESERVATION 0x10000000
+#endif
+
+/* the NUMA nodes that local allocators have allocators for. the nodes beyond
+share theirs */
+#if !defined(MAXIMUM_NODES_COUNT)
+#define MAXIMUM_NODES_COUNT 8
+#endif
+
+/* the picks of local allocators between each thread's queries of its node */
+#if !defined(LOCAL_NODE_PERIOD)
+#define LOCAL_NODE_PERIOD 256
 #endif
 
 /******************************************************************************/
@@ -117,32 +221,162 @@ PRIVATE INLINED Size AlignForwards(Size address, Size alignment) {
 
 /******************************************************************************/
 
-Size QueryVirtualMemoryGranularity(void);
-Size QueryVirtualMemoryGranularity(void);
+PUBLIC Size QueryVirtualMemoryGranularity(void);
+
+PUBLIC Address AllocateVirtualMemory(Size size);
+
+/* NOTE(Emhyr): returns 0 instead of trapping when the memory's exhausted */
+PUBLIC Address TryAllocateVirtualMemory(Size size);
+
+PUBLIC Address ReserveVirtualMemory(Size size);
+PUBLIC void    ReleaseVirtualMemory(Address address, Size size);
+
+PUBLIC void CommitVirtualMemory  (Address address, Size size);
+PUBLIC void DecommitVirtualMemory(Address address, Size size);
+
+/* releases the physical memory of committed pages, which remain committed. their
+contents are undefined afterwards */
+PUBLIC void ResetVirtualMemory(Address address, Size size);
+
+/* NOTE(Emhyr): commits pages that prefer to be backed by `node`'s memory. the
+preference is advisory, so it's ignored where it's unsupported */
+PUBLIC void CommitVirtualMemoryOnNode(Address address, Size size, Size node);
+
+/* NOTE(Emhyr): the NUMA nodes, and the one that the current thread runs on */
+PUBLIC Size QueryNodesCount (void);
+PUBLIC Size QueryCurrentNode(void);
+
+PUBLIC void ValidateVirtualMemory  (Address address, Size size);
+PUBLIC void InvalidateVirtualMemory(Address address, Size size);
+
+PUBLIC Boolean CheckCommittedVirtualMemory(Address address, Size size);
+
+PUBLIC void TouchVirtualMemory   (Address address, Size size);
+PUBLIC void PrefaultVirtualMemory(Address address, Size size);
+
+/* statistics *****************************************************************/
+
+#if ENABLE_STATISTICS
+
+#define MEMORY_KIND_LINEAR   1
+#define MEMORY_KIND_GRANULAR 2
+
+/* NOTE(Emhyr): each allocator only counts what's relevant to its kind */
 
-Address AllocateVirtualMemory(Size size);
+typedef struct MemoryStatistics MemoryStatistics;
+struct MemoryStatistics {
+	Size pushes;
+	Size pulls;
+	Size puts;
+	Size pops;
+	Size commits;
+	Size committed;
+	Size decommitted;
+	Size highestExtent;
+	Size liveGranules;
 
-Address ReserveVirtualMemory(Size size);
-void    ReleaseVirtualMemory(Address address, Size size);
+	/* NOTE(Emhyr): the registry's */
+	MemoryStatistics *previous;
+	MemoryStatistics *next;
+	void             *allocator;
+	int               kind;
+};
 
-void CommitVirtualMemory  (Address address, Size size);
-void DecommitVirtualMemory(Address address, Size size);
+#endif
+
+/* waning *********************************************************************/
+
+/* a waning policy defers the decommits of an allocator's waned procedures to a
+background reclaimer, with hysteresis: nothing is decommitted until the
+commission exceeds the extent by more than `highWatermark`, then it's
+decommitted down to `lowWatermark` beyond the extent after `delay` milliseconds,
+unless the allocator regrows first.
+
+each allocator needs its own policy, and should detach it before being
+released. */
+
+typedef struct WaningPolicy WaningPolicy;
+struct WaningPolicy {
+	Size lowWatermark;
+	Size highWatermark;
+	U64  delay;
+
+	/* NOTE(Emhyr): the reclaimer's */
+	volatile Word lock;
+	void         *allocator;
+	Size          committed;
+	U64           deadline;
+	Boolean       queued;
+	WaningPolicy *next;
+};
+
+/* persistence ****************************************************************/
+
+/* a persistent linear allocator maps a file instead of anonymous memory. the
+file begins with a page for a header, after which it mirrors the allocator's
+commission, so raising the commission extends the file. the allocator is
+reopened with its extent, and the extents are persisted by syncing or closing.
+
+when it's reopened, it's mapped at the address where it was created if that's
+vacant, so its absolute pointers remain valid. otherwise, `relocated` is set,
+and only offsets from the allocator's address are valid. the first push is at
+the allocator's address, so it can hold the root of whatever's persisted:
+
+	Persistence persistence;
+	LinearAllocator arena = {.reservation = 1ull << 32};
+	if (!OpenPersistentLinearAllocator("index.bin", 0, &persistence, &arena)) ...
+	Index *index = arena.extent ? (Index *)arena.address : Push(sizeof(Index), 8, &arena);
+	...
+	ClosePersistentLinearAllocator(&arena);
+
+without a path, the file is anonymous (a memfd), which is only useful for
+snapshots: a snapshot remaps the allocator privately, so its writes are copied
+upon their first touch of each page and the file keeps the snapshot's state.
+discarding the snapshot remaps the file to roll everything back, including the
+extent. committing it writes the touched pages back to the file first. there can
+only be one snapshot at a time.
+
+	SnapshotLinearAllocator(&arena);
+	Try(&arena);
+	if (didSucceed) CommitLinearSnapshot(&arena);
+	else DiscardLinearSnapshot(&arena);
+
+its pages are never waned, since they're the file's. it's only supported on
+unix. */
+
+typedef struct {
+	Boolean relocated;
 
-void ValidateVirtualMemory  (Address address, Size size);
-void InvalidateVirtualMemory(Address address, Size size);
+	/* NOTE(Emhyr): the allocator's */
+	Word    handle;
+	Boolean snapshotted;
+	Size    snapshotExtent;
+	Size    snapshotCommission;
+} Persistence;
 
-Boolean CheckCommittedVirtualMemory(Address address, Size size);
+/* node affinity **************************************************************/
 
-void TouchVirtualMemory(Address address, Size size);
+/* the linear and granular allocators commit their pages on the NUMA node of
+their `affinity`, so the pages are local to it regardless of which thread first
+touches them. it's `NODE_AFFINITY(node)`, or 0 for any node, which leaves the
+pages to the system's policy. */
+
+#define NODE_AFFINITY(node) ((node) + 1)
 
 /* linear allocator ***********************************************************/
 
 typedef struct {
-	Size    reservation;
-	Address address;
-	Size    factor;
-	Size    commission;
-	Size    extent;
+	Size          reservation;
+	Address       address;
+	Size          factor;
+	Size          commission;
+	Size          extent;
+	WaningPolicy *waning;
+	Persistence  *persistence;
+	Size          affinity;
+#if ENABLE_STATISTICS
+	MemoryStatistics statistics;
+#endif
 } LinearAllocator;
 
 typedef LinearAllocator Arena;
@@ -184,6 +418,7 @@ PUBLIC void *DebugPush           (Size size, Size alignment, LinearAllocator *co
 PUBLIC void *DebugPushZeroed     (Size size, Size alignment, LinearAllocator *context);
 PUBLIC void *DebugPushFrame      (Size size, Size alignment, LinearAllocator *context);
 PUBLIC void *DebugPushFrameZeroed(Size size, Size alignment, LinearAllocator *context);
+PUBLIC void *Repush              (void *address, Size size, Size newSize, Size alignment, LinearAllocator *context);
 
 /* linear allocator / deallocation ********************************************/
 PUBLIC void  Pull               (Size size, Size alignment, LinearAllocator *context);
@@ -195,13 +430,139 @@ PUBLIC void  DebugPullWaned     (Size size, Size alignment, LinearAllocator *con
 PUBLIC void  DebugPullFrame     (void *address, LinearAllocator *context);
 PUBLIC void  DebugPullFrameWaned(void *address, LinearAllocator *context);
 
+/* linear allocator / waning **************************************************/
+PUBLIC void AttachWaningPolicy(WaningPolicy *policy, LinearAllocator *context);
+PUBLIC void DetachWaningPolicy(LinearAllocator *context);
+
+/* linear allocator / persistence *********************************************/
+
+/* NOTE(Emhyr): the file is created if it doesn't exist, or it's anonymous if
+`path` is null. `base` is the address to create the allocator at, or 0 for any.
+a reopened allocator's reservation is at least its commission. returns whether
+the file could be opened and mapped, and is a valid allocator's */
+PUBLIC Boolean OpenPersistentLinearAllocator (const char *path, Address base, Persistence *persistence, LinearAllocator *context);
+PUBLIC void    SyncPersistentLinearAllocator (LinearAllocator *context);
+PUBLIC void    ClosePersistentLinearAllocator(LinearAllocator *context);
+
+/* linear allocator / snapshots ***********************************************/
+PUBLIC void SnapshotLinearAllocator(LinearAllocator *context);
+PUBLIC void CommitLinearSnapshot   (LinearAllocator *context);
+PUBLIC void DiscardLinearSnapshot  (LinearAllocator *context);
+
+/* NOTE(Emhyr): offsets from the allocator's address remain valid wherever it's mapped */
+PRIVATE INLINED Size Relativize(const void *pointer, LinearAllocator *context) {
+	return (Address)pointer - context->address;
+}
+
+PRIVATE INLINED void *Absolutize(Size offset, LinearAllocator *context) {
+	return (void *)(context->address + offset);
+}
+
+/* scratch arenas *************************************************************/
+
+/* each thread has `SCRATCH_ARENAS_COUNT` linear allocators for temporary
+memory, reserved upon their first use. `GetScratch` returns one that isn't any
+of `conflicts`, which should be the arenas that the caller holds, e.g. the one
+that its result will be pushed onto. the returned arena is used through frames:
+
+	Byte *bytes = PushFrame(size, 1, scratch);
+	...
+	PullFrame(bytes, scratch);
+
+`GetScratchAvoiding` takes the conflicts as its arguments, and at least one of
+them, since C11 has no empty initializers; `GetAnyScratch` is for none.
+
+a thread should release its scratch arenas before exiting. */
+
+PUBLIC LinearAllocator *GetScratch     (Size conflictsCount, LinearAllocator *const *conflicts);
+PUBLIC void             ReleaseScratches(void);
+
+#define GetScratchAvoiding(...) GetScratch(sizeof((LinearAllocator *[]){__VA_ARGS__}) / sizeof(LinearAllocator *), (LinearAllocator *[]){__VA_ARGS__})
+#define GetAnyScratch()         GetScratch(0, 0)
+
+/* chained linear allocator ***************************************************/
+
+/* a linear allocator that chains another reservation whenever the current one
+is exhausted, so that it needn't be reserved for the worst case. each block is
+reserved by `reservation`, or more for a larger push.
+
+it's pushed and pulled through frames, which pull back across blocks. emptied
+blocks are kept for reuse until the allocator is destroyed. waning policies
+aren't supported. */
+
+typedef struct LinearBlock LinearBlock;
+
+typedef struct {
+	LinearAllocator allocator;
+	Size            reservation;
+	LinearBlock    *spares;
+} ChainedLinearAllocator;
+
+typedef ChainedLinearAllocator ChainedArena;
+
+/* chained linear allocator / destruction *************************************/
+PUBLIC void ClearChainedLinearAllocator  (ChainedLinearAllocator *context);
+PUBLIC void DestroyChainedLinearAllocator(ChainedLinearAllocator *context);
+
+/* chained linear allocator / allocation **************************************/
+PUBLIC void *PushChained           (Size size, Size alignment, ChainedLinearAllocator *context);
+PUBLIC void *PushChainedZeroed     (Size size, Size alignment, ChainedLinearAllocator *context);
+PUBLIC void *PushFrameChained      (Size size, Size alignment, ChainedLinearAllocator *context);
+PUBLIC void *PushFrameChainedZeroed(Size size, Size alignment, ChainedLinearAllocator *context);
+
+/* chained linear allocator / deallocation ************************************/
+PUBLIC void PullFrameChained(void *address, ChainedLinearAllocator *context);
+
+/* shared linear allocator ****************************************************/
+
+/* a linear allocator that can be pushed by multiple threads at once. each push
+claims its addresses with a single atomic addition, and whichever thread first
+crosses the commission commits for the others.
+
+frames, pulls and clears remain single-owner: they must only be used with
+`allocator` while no other thread pushes. */
+
+typedef struct {
+	LinearAllocator allocator;
+	volatile Word   lock;
+} SharedLinearAllocator;
+
+typedef SharedLinearAllocator SharedArena;
+
+/* shared linear allocator / allocation ***************************************/
+PUBLIC void *PushShared      (Size size, Size alignment, SharedLinearAllocator *context);
+PUBLIC void *PushSharedZeroed(Size size, Size alignment, SharedLinearAllocator *context);
+
 /* granular allocator *********************************************************/
 
+/* the quantity grows on demand, without moving any blocks, until the capacity.
+by default, the capacity is whatever fits the reservation.
+
+the placement decides which clear run a put takes:
+
+	first-fit - the first run. it's the default.
+	next-fit  - the first run from the end of the last put, wrapping around. it
+	            avoids rescanning a saturated beginning.
+	best-fit  - the smallest of the runs within the first `BEST_FIT_PROBES`
+	            words that fit, for runs that fit within a word. it avoids
+	            splitting larger runs. */
+
+#define PLACEMENT_FIRST_FIT 0
+#define PLACEMENT_NEXT_FIT  1
+#define PLACEMENT_BEST_FIT  2
+
 typedef struct {
 	Size    reservation;
 	Address address;
 	Size    granularity;
 	Size    quantity;
+	Size    capacity;
+	Size    placement;
+	Size    cursor;
+	Size    affinity;
+#if ENABLE_STATISTICS
+	MemoryStatistics statistics;
+#endif
 } GranularAllocator;
 
 /* NOTE(Emhyr): etymology: "granular" for consistency with the adjective "linear" in `LinearAllocator` */
@@ -219,9 +580,141 @@ PUBLIC void ClearGranularAllocatorWaned(GranularAllocator *context);
 /* granular allocator / allocation ********************************************/
 PUBLIC void *Put      (Size size, GranularAllocator *context);
 PUBLIC void *PutZeroed(Size size, GranularAllocator *context);
+PUBLIC void *Reput    (void *address, Size size, Size newSize, GranularAllocator *context);
 
 /* granular allocator / deallocation ******************************************/
 PUBLIC void Pop     (void *address, Size size, GranularAllocator *context);
 PUBLIC void PopWaned(void *address, Size size, GranularAllocator *context);
 
+/* granular allocator / inspection ********************************************/
+
+/* NOTE(Emhyr): begins to iterate the indices of the allocator's put granules.
+the `i`th granule is at `address + i * granularity` */
+PUBLIC void BeginGranularIteration(BitIterator *iterator, GranularAllocator *context);
+
+/* shared granular allocator **************************************************/
+
+/* a granular allocator that can be shared between threads. each thread caches
+magazines of runs per size class, so most puts and pops don't touch the
+allocator at all. sizes beyond the largest class go through the lock.
+
+an address must be popped by the same family of procedures that put it, and a
+thread should flush its caches before exiting. otherwise, its cached runs remain
+locked. */
+
+typedef struct {
+	GranularAllocator allocator;
+	volatile Word     lock;
+} SharedGranularAllocator;
+
+typedef SharedGranularAllocator SharedPool;
+
+/* shared granular allocator / allocation *************************************/
+PUBLIC void *PutCached      (Size size, SharedGranularAllocator *context);
+PUBLIC void *PutCachedZeroed(Size size, SharedGranularAllocator *context);
+
+/* shared granular allocator / deallocation ***********************************/
+PUBLIC void PopCached  (void *address, Size size, SharedGranularAllocator *context);
+PUBLIC void FlushCaches(SharedGranularAllocator *context);
+
+/* segregated allocator *******************************************************/
+
+/* a general-purpose allocator of shared granular allocators, one per size
+class, that lie consecutively in one reservation. the size of a block is
+therefore known by its address, so deallocation doesn't need it. larger blocks
+are allocated directly from virtual memory behind a header.
+
+it's thread-safe. each thread caches magazines of blocks for one segregated
+allocator at a time, and should flush them before exiting. */
+
+typedef struct {
+	Address                 address;
+	SharedGranularAllocator classes[SEGREGATED_CLASSES_COUNT];
+	volatile Word           lock;
+} SegregatedAllocator;
+
+typedef SegregatedAllocator Heap;
+
+/* segregated allocator / creation ********************************************/
+PUBLIC void InitializeSegregatedAllocator(SegregatedAllocator *context);
+
+/* segregated allocator / allocation ******************************************/
+PUBLIC void *Allocate       (Size size, Size alignment, SegregatedAllocator *context);
+PUBLIC void *AllocateZeroed (Size size, Size alignment, SegregatedAllocator *context);
+PUBLIC void *Reallocate     (void *address, Size size, Size alignment, SegregatedAllocator *context);
+PUBLIC Size  GaugeAllocation(void *address, SegregatedAllocator *context);
+
+/* segregated allocator / deallocation ****************************************/
+PUBLIC void Deallocate           (void *address, SegregatedAllocator *context);
+PUBLIC void FlushSegregatedCaches(SegregatedAllocator *context);
+
+/* local allocators ***********************************************************/
+
+/* a shared linear allocator and a shared granular allocator per NUMA node,
+whose pages are committed on their node. each thread pushes and puts upon the
+allocators of the node that it runs on, which it requeries every
+`LOCAL_NODE_PERIOD` picks. on a single node, there's one of each, and they have
+no affinity, so they're just shared allocators.
+
+the first node's allocators are configured before the initialization, which
+copies their configurations for the other nodes:
+
+	LocalAllocators locals = {0};
+	locals.granulars[0].allocator.granularity = 64;
+	InitializeLocalAllocators(&locals);
+	void *node = PutLocal(48, &locals); */
+
+typedef struct {
+	Size                    nodesCount;
+	SharedLinearAllocator   linears  [MAXIMUM_NODES_COUNT];
+	SharedGranularAllocator granulars[MAXIMUM_NODES_COUNT];
+} LocalAllocators;
+
+/* local allocators / creation ************************************************/
+PUBLIC void InitializeLocalAllocators(LocalAllocators *context);
+
+/* local allocators / allocation **********************************************/
+PUBLIC void *PushLocal(Size size, Size alignment, LocalAllocators *context);
+PUBLIC void *PutLocal (Size size, LocalAllocators *context);
+
+/* local allocators / deallocation ********************************************/
+
+/* NOTE(Emhyr): the address is popped to the node that it was put upon, which
+may not be the current one */
+PUBLIC void PopLocal(void *address, Size size, LocalAllocators *context);
+
+/* registry *******************************************************************/
+
+#if ENABLE_STATISTICS
+
+/* allocators aren't registered automatically, since they may be copied (e.g.
+`MakeLinearAllocator`). unregister them before they're released */
+
+typedef struct {
+	int              kind;
+	void            *allocator;
+	Size             reservation;
+	Size             commission;  /* NOTE(Emhyr): linear only */
+	Size             extent;      /* NOTE(Emhyr): linear only */
+	Size             granularity; /* NOTE(Emhyr): granular only */
+	Size             quantity;    /* NOTE(Emhyr): granular only */
+	Size             largestRun;  /* NOTE(Emhyr): granular only. the largest run of vacant granules */
+	MemoryStatistics statistics;
+} MemoryReport;
+
+typedef void MemoryVisitor(const MemoryReport *report, void *user);
+
+PUBLIC void RegisterLinearAllocator    (LinearAllocator *context);
+PUBLIC void UnregisterLinearAllocator  (LinearAllocator *context);
+PUBLIC void RegisterGranularAllocator  (GranularAllocator *context);
+PUBLIC void UnregisterGranularAllocator(GranularAllocator *context);
+
+/* NOTE(Emhyr): the registry is locked while visiting */
+PUBLIC void VisitAllocators(MemoryVisitor *visitor, void *user);
+
+/* writes a line of text per allocator, and returns the amount of bytes needed */
+PUBLIC Size DumpAllocators(Byte *buffer, Size size);
+
+#endif
+
 #endif
@@ -0,0 +1,256 @@
+/*
+C++ adapters of the allocators, for the standard containers. it needs C++17.
+
+`LinearResource` and `PooledResource` are `std::pmr::memory_resource`s: the
+former is monotonic upon `Push`, and the latter puts and pops upon a granular
+allocator per size class. `ArenaAllocator` and `PoolAllocator` are the templated
+allocators of the same, for containers that aren't polymorphic. the pool
+allocator selects its type's size class when it's compiled, so the nodes of
+`std::map`s, `std::list`s and `std::unordered_map`s don't search for it.
+
+a `FrameScope` pushes a frame upon its construction and pulls it upon its
+destruction, so everything pushed within it is released at once. containers
+that are made by `New` aren't destructed, so a whole graph of them is released
+without visiting it:
+
+	LinearAllocator arena = {0};
+	{
+		FrameScope frame(&arena);
+		auto *names = frame.New<std::pmr::vector<std::pmr::string>>(frame.GetResource());
+		names->emplace_back("seven");
+	}
+
+the resources and allocators don't own their allocators, which must outlive
+them. they throw `std::bad_alloc` when their allocators are exhausted.
+*/
+
+#if !defined(INCLUDED_BASICS_MEMORY_HPP)
+#define INCLUDED_BASICS_MEMORY_HPP
+
+#include "basics_memory.h"
+
+#if __cplusplus < 201703L
+#error "basics_memory.hpp needs C++17"
+#endif
+
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+/******************************************************************************/
+/* settings */
+
+/* the granularity of the smallest size class of a pooled resource. it must be a power of 2 */
+#if !defined(POOLED_SMALLEST_GRANULARITY)
+#define POOLED_SMALLEST_GRANULARITY 16
+#endif
+
+/* the size classes of a pooled resource, each twice the granularity of the last */
+#if !defined(POOLED_CLASSES_COUNT)
+#define POOLED_CLASSES_COUNT 8
+#endif
+
+/******************************************************************************/
+
+/* NOTE(Emhyr): returns the largest class whose granularity doesn't exceed
+`size`, or a larger one whose granularity satisfies `alignment`. the largest
+class takes whatever's larger */
+constexpr Size SelectPooledClass(Size size, Size alignment) noexcept {
+	Size k = 0;
+	Size granularity = POOLED_SMALLEST_GRANULARITY;
+	while (k + 1 < POOLED_CLASSES_COUNT && (granularity < alignment || granularity * 2 <= size)) {
+		granularity *= 2;
+		++k;
+	}
+	return k;
+}
+
+constexpr Size GaugePooledGranularity(Size k) noexcept {
+	return (Size)POOLED_SMALLEST_GRANULARITY << k;
+}
+
+/* linear resource ************************************************************/
+
+class LinearResource : public std::pmr::memory_resource {
+public:
+	explicit LinearResource(LinearAllocator *allocator) noexcept : allocator(allocator) {}
+
+	LinearAllocator *GetAllocator() const noexcept { return allocator; }
+
+private:
+	LinearAllocator *allocator;
+
+	void *do_allocate(std::size_t size, std::size_t alignment) override {
+		void *result = Push(size, alignment, allocator);
+		if (!result) throw std::bad_alloc();
+		return result;
+	}
+
+	/* NOTE(Emhyr): it's monotonic, so the memory is released by pulling frames
+	or clearing the allocator */
+	void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		const LinearResource *resource = dynamic_cast<const LinearResource *>(&other);
+		return resource && resource->allocator == allocator;
+	}
+};
+
+/* pooled resource ************************************************************/
+
+/* NOTE(Emhyr): the classes are ZII, so they can be configured before their
+first puts. their reservations are released upon destruction */
+
+class PooledResource : public std::pmr::memory_resource {
+public:
+	GranularAllocator classes[POOLED_CLASSES_COUNT];
+
+	PooledResource() noexcept : classes() {
+		for (Size k = 0; k < POOLED_CLASSES_COUNT; ++k) classes[k].granularity = GaugePooledGranularity(k);
+	}
+
+	PooledResource(const PooledResource &) = delete;
+	PooledResource &operator=(const PooledResource &) = delete;
+
+	~PooledResource() {
+		for (Size k = 0; k < POOLED_CLASSES_COUNT; ++k)
+			if (classes[k].address) ReleaseVirtualMemory(classes[k].address, classes[k].reservation);
+	}
+
+	void *PutClassed(Size k, Size size) {
+		void *result = Put(size, &classes[k]);
+		if (!result) throw std::bad_alloc();
+		return result;
+	}
+
+	void PopClassed(Size k, void *address, Size size) noexcept {
+		Pop(address, size, &classes[k]);
+	}
+
+private:
+	void *do_allocate(std::size_t size, std::size_t alignment) override {
+		if (alignment > GaugePooledGranularity(POOLED_CLASSES_COUNT - 1)) throw std::bad_alloc();
+		return PutClassed(SelectPooledClass(size, alignment), size);
+	}
+
+	void do_deallocate(void *address, std::size_t size, std::size_t alignment) override {
+		PopClassed(SelectPooledClass(size, alignment), address, size);
+	}
+
+	bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+		return this == &other;
+	}
+};
+
+/* arena allocator ************************************************************/
+
+template <typename T>
+class ArenaAllocator {
+public:
+	using value_type = T;
+
+	LinearAllocator *allocator;
+
+	explicit ArenaAllocator(LinearAllocator *allocator) noexcept : allocator(allocator) {}
+
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &other) noexcept : allocator(other.allocator) {}
+
+	T *allocate(std::size_t n) {
+		if (n > (Size)-1 / sizeof(T)) throw std::bad_array_new_length();
+		void *result = Push(n * sizeof(T), alignof(T), allocator);
+		if (!result) throw std::bad_alloc();
+		return static_cast<T *>(result);
+	}
+
+	/* NOTE(Emhyr): only the last push is pulled, so memory that's deallocated
+	in reverse, e.g. a temporary container's, is reused. a growing container's
+	old storage lies beneath its new storage, so it's left until the frame's
+	pulled */
+	void deallocate(T *address, std::size_t n) noexcept {
+		if ((Byte *)(address + n) == (Byte *)(allocator->address + allocator->extent)) {
+			Pull(n * sizeof(T), 1, allocator);
+		}
+	}
+
+	template <typename U>
+	bool operator==(const ArenaAllocator<U> &other) const noexcept { return allocator == other.allocator; }
+
+	template <typename U>
+	bool operator!=(const ArenaAllocator<U> &other) const noexcept { return allocator != other.allocator; }
+};
+
+/* pool allocator *************************************************************/
+
+template <typename T>
+class PoolAllocator {
+public:
+	using value_type = T;
+
+	PooledResource *resource;
+
+	explicit PoolAllocator(PooledResource *resource) noexcept : resource(resource) {}
+
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U> &other) noexcept : resource(other.resource) {}
+
+	/* NOTE(Emhyr): single elements, e.g. nodes, are put in the class that's
+	selected at compile-time */
+	T *allocate(std::size_t n) {
+		constexpr Size k = SelectPooledClass(sizeof(T), alignof(T));
+		static_assert(alignof(T) <= GaugePooledGranularity(k), "the type's alignment exceeds the largest class's granularity");
+		if (n == 1) return static_cast<T *>(resource->PutClassed(k, sizeof(T)));
+		if (n > (Size)-1 / sizeof(T)) throw std::bad_array_new_length();
+		return static_cast<T *>(resource->PutClassed(SelectPooledClass(n * sizeof(T), alignof(T)), n * sizeof(T)));
+	}
+
+	void deallocate(T *address, std::size_t n) noexcept {
+		constexpr Size k = SelectPooledClass(sizeof(T), alignof(T));
+		if (n == 1) resource->PopClassed(k, address, sizeof(T));
+		else resource->PopClassed(SelectPooledClass(n * sizeof(T), alignof(T)), address, n * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U> &other) const noexcept { return resource == other.resource; }
+
+	template <typename U>
+	bool operator!=(const PoolAllocator<U> &other) const noexcept { return resource != other.resource; }
+};
+
+/* frame scope ****************************************************************/
+
+class FrameScope {
+public:
+	explicit FrameScope(LinearAllocator *allocator) : resource(allocator) {
+		frame = PushFrame(0, 1, allocator);
+		if (!frame) throw std::bad_alloc();
+	}
+
+	FrameScope(const FrameScope &) = delete;
+	FrameScope &operator=(const FrameScope &) = delete;
+
+	~FrameScope() {
+		PullFrame(frame, resource.GetAllocator());
+	}
+
+	LinearResource *GetResource() noexcept { return &resource; }
+
+	template <typename T>
+	ArenaAllocator<T> GetAllocator() const noexcept { return ArenaAllocator<T>(resource.GetAllocator()); }
+
+	/* NOTE(Emhyr): the object is never destructed. its memory is released with
+	the frame's */
+	template <typename T, typename... Arguments>
+	T *New(Arguments &&...arguments) {
+		void *address = Push(sizeof(T), alignof(T), resource.GetAllocator());
+		if (!address) throw std::bad_alloc();
+		return new (address) T(std::forward<Arguments>(arguments)...);
+	}
+
+private:
+	LinearResource resource;
+	void          *frame;
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include "basics_string.h"
+
+/******************************************************************************/
+/* auxiliaries */
+
+EXTERNAL void *CCALL memcpy   (void *RESTRICT, const void *RESTRICT, unsigned long long);
+EXTERNAL int   CCALL memcmp   (const void *, const void *, unsigned long long);
+EXTERNAL int   CCALL vsnprintf(char *RESTRICT, unsigned long long, const char *RESTRICT, VArgs);
+
+#define Copy(d, s, n)    (void)memcpy(d, s, n)
+#define Compare(a, b, n) memcmp(a, b, n)
+
+/******************************************************************************/
+
+Boolean CompareStrings(String a, String b) {
+	return a.size == b.size && (a.bytes == b.bytes || !Compare(a.bytes, b.bytes, a.size));
+}
+
+String PushString(String string, LinearAllocator *context) {
+	StringBuilder builder;
+	BeginString(context, &builder);
+	AppendString(string, &builder);
+	return EndString(&builder);
+}
+
+String PushFormat(LinearAllocator *context, const char *format, ...) {
+	VArgs arguments;
+	BeginVArgs(arguments, format);
+	String result = PushFormatVaried(format, arguments, context);
+	EndVArgs(arguments);
+	return result;
+}
+
+String PushFormatVaried(const char *format, VArgs arguments, LinearAllocator *context) {
+	StringBuilder builder;
+	BeginString(context, &builder);
+	AppendFormatVaried(format, arguments, &builder);
+	return EndString(&builder);
+}
+
+/* string builder *************************************************************/
+
+void BeginString(LinearAllocator *arena, StringBuilder *context) {
+	if (!arena->address) InitializeLinearAllocator(arena);
+	context->arena = arena;
+	context->bytes = (Byte *)(arena->address + arena->extent);
+	context->size  = 0;
+}
+
+/* NOTE(Emhyr): the pushes are unaligned, so they're consecutive */
+PRIVATE inline Byte *ExtendString(Size size, StringBuilder *context) {
+	Byte *result = Push(size, 1, context->arena);
+	Assert(result, "overflowed! the arena's reservation is too small");
+	Assert(result == context->bytes + context->size, "something else was pushed onto the arena while building");
+	context->size += size;
+	return result;
+}
+
+void AppendBytes(const void *bytes, Size size, StringBuilder *context) {
+	Copy(ExtendString(size, context), bytes, size);
+}
+
+void AppendString(String string, StringBuilder *context) {
+	AppendBytes(string.bytes, string.size, context);
+}
+
+void AppendFormat(StringBuilder *context, const char *format, ...) {
+	VArgs arguments;
+	BeginVArgs(arguments, format);
+	AppendFormatVaried(format, arguments, context);
+	EndVArgs(arguments);
+}
+
+/* NOTE(Emhyr): it's formatted straight into the committed memory beyond the
+extent. only if it doesn't fit there is more committed and it's formatted again */
+void AppendFormatVaried(const char *format, VArgs arguments, StringBuilder *context) {
+	LinearAllocator *arena = context->arena;
+	Byte *top = context->bytes + context->size;
+	Size room = arena->address + arena->commission - (Address)top;
+	VArgs copy;
+	CopyVArgs(copy, arguments);
+	int size = vsnprintf((char *)top, room, format, copy);
+	EndVArgs(copy);
+	Assert(size >= 0, "the format is invalid");
+	if ((Size)size < room) {
+		ExtendString(size, context);
+		return;
+	}
+
+	/* NOTE(Emhyr): the null byte is written too, but it's pulled afterwards */
+	ExtendString(size + 1, context);
+	vsnprintf((char *)top, size + 1, format, arguments);
+	Pull(1, 1, arena);
+	context->size -= 1;
+}
+
+/* NOTE(Emhyr): the null byte is pushed, but isn't counted */
+String EndString(StringBuilder *context) {
+	*ExtendString(1, context) = 0;
+	String result = {context->bytes, context->size - 1};
+	context->arena = 0;
+	return result;
+}
+
+/* string interner ************************************************************/
+
+/* NOTE(Emhyr): the table maps hashes to chains of strings, which only collide
+by their hashes rarely */
+struct InternedString {
+	InternedString *next;
+	Size            size;
+	Byte            bytes[];
+};
+
+String InternString(String string, Interner *context) {
+	Table *table = &context->table;
+	if (!table->keySize) {
+		table->keySize   = sizeof(U64);
+		table->valueSize = sizeof(InternedString *);
+		table->linear    = context->arena;
+	}
+
+	U64 hash = HashBytes(string.bytes, string.size);
+	InternedString **chain = InsertTableEntry(&hash, 0, table);
+	for (InternedString *interned = *chain; interned; interned = interned->next) {
+		if (interned->size == string.size && !Compare(interned->bytes, string.bytes, string.size))
+			return (String){interned->bytes, interned->size};
+	}
+
+	InternedString *interned = Push(sizeof(InternedString) + string.size + 1, ALIGNOF(InternedString), context->arena);
+	Assert(interned, "overflowed! the arena's reservation is too small");
+	interned->next = *chain;
+	interned->size = string.size;
+	Copy(interned->bytes, string.bytes, string.size);
+	interned->bytes[string.size] = 0;
+	*chain = interned;
+	return (String){interned->bytes, interned->size};
+}
+
+void ResetInterner(Interner *context) {
+	ReleaseTable(&context->table);
+}
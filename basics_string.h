@@ -0,0 +1,71 @@
+/*
+strings upon linear allocators. a string is a size and its bytes, which are
+followed by a null byte when they're made here, for C's sake.
+
+a builder appends to the top of its arena in place, so nothing else may be
+pushed onto the arena until it ends:
+
+	StringBuilder builder;
+	BeginString(arena, &builder);
+	AppendString(STRING("identifier"), &builder);
+	AppendFormat(&builder, "_%llu", index);
+	String identifier = EndString(&builder);
+
+an interner returns the same bytes for the same string, so interned strings
+are compared by their pointers. their bytes are pushed consecutively onto the
+interner's arena.
+
+everything lies in the arena, so the strings of a frame vanish with
+`PullFrame`. an interner whose memory was pulled must be reset.
+*/
+
+#if !defined(INCLUDED_BASICS_STRING_H)
+#define INCLUDED_BASICS_STRING_H
+
+#include "basics_memory.h"
+#include "basics_table.h"
+
+typedef struct {
+	Byte *bytes;
+	Size  size;
+} String;
+
+#define STRING(literal) ((String){(Byte *)(literal), sizeof(literal) - 1})
+
+/* NOTE(Emhyr): the variadic procedures take their context first, since it
+can't follow the arguments */
+
+PUBLIC Boolean CompareStrings(String a, String b);
+
+PUBLIC String PushString      (String string, LinearAllocator *context);
+PUBLIC String PushFormat      (LinearAllocator *context, const char *format, ...);
+PUBLIC String PushFormatVaried(const char *format, VArgs arguments, LinearAllocator *context);
+
+/* string builder *************************************************************/
+
+typedef struct {
+	LinearAllocator *arena;
+	Byte            *bytes;
+	Size             size;
+} StringBuilder;
+
+PUBLIC void   BeginString       (LinearAllocator *arena, StringBuilder *context);
+PUBLIC void   AppendBytes       (const void *bytes, Size size, StringBuilder *context);
+PUBLIC void   AppendString      (String string, StringBuilder *context);
+PUBLIC void   AppendFormat      (StringBuilder *context, const char *format, ...);
+PUBLIC void   AppendFormatVaried(const char *format, VArgs arguments, StringBuilder *context);
+PUBLIC String EndString         (StringBuilder *context);
+
+/* string interner ************************************************************/
+
+typedef struct InternedString InternedString;
+
+typedef struct {
+	LinearAllocator *arena;
+	Table            table;
+} Interner;
+
+PUBLIC String InternString (String string, Interner *context);
+PUBLIC void   ResetInterner(Interner *context);
+
+#endif
@@ -0,0 +1,335 @@
+#include "basics_table.h"
+#include "basics_bits.h"
+
+/******************************************************************************/
+/* auxiliaries */
+
+EXTERNAL void *CCALL memcpy(void *RESTRICT, const void *RESTRICT, unsigned long long);
+EXTERNAL void *CCALL memset(void *, int, unsigned long long);
+EXTERNAL int   CCALL memcmp(const void *, const void *, unsigned long long);
+
+#define Copy(d, s, n)    (void)memcpy(d, s, n)
+#define Fill(d, c, n)    (void)memset(d, c, n)
+#define Zero(d, n)       Fill(d, 0, n)
+#define Compare(a, b, n) memcmp(a, b, n)
+
+/* NOTE(Emhyr): a full slot's control byte is the lowest 7 bits of its hash, so
+only the vacant ones have the most significant bit set */
+#define CONTROL_EMPTY   0x80
+#define CONTROL_DELETED 0xFE
+
+/* groups *********************************************************************/
+
+/* NOTE(Emhyr): a group's matches are a mask, whose set bits are iterated by
+`GetMatchIndex` */
+
+#if defined(ARCHITECTURE_IS_X64)
+
+#define GROUP_WIDTH 16
+
+PRIVATE inline Bits64 MatchGroup(U8 control, const U8 *group) {
+	__m128i x = _mm_loadu_si128((const __m128i *)group);
+	return (U32)_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8((char)control)));
+}
+
+PRIVATE inline Bits64 MatchVacancies(const U8 *group) {
+	return (U32)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+
+PRIVATE inline Bits64 MatchEmpties(const U8 *group) {
+	return MatchGroup(CONTROL_EMPTY, group);
+}
+
+#define GetMatchIndex(matches)     BitScanForward(matches)
+#define GetLastMatchIndex(matches) BitScanReverse(matches)
+
+#else
+
+#define GROUP_WIDTH 8
+
+#define LOWS  0x0101010101010101ull
+#define HIGHS 0x8080808080808080ull
+
+PRIVATE inline Bits64 LoadGroup(const U8 *group) {
+	Bits64 result;
+	Copy(&result, group, sizeof(result));
+	return result;
+}
+
+/* NOTE(Emhyr): may match a byte falsely if it follows a true match, which the
+keys' comparison rejects */
+PRIVATE inline Bits64 MatchGroup(U8 control, const U8 *group) {
+	Bits64 x = LoadGroup(group) ^ LOWS * control;
+	return (x - LOWS) & ~x & HIGHS;
+}
+
+PRIVATE inline Bits64 MatchVacancies(const U8 *group) {
+	return LoadGroup(group) & HIGHS;
+}
+
+/* NOTE(Emhyr): an empty byte is the only vacant one whose second bit is clear */
+PRIVATE inline Bits64 MatchEmpties(const U8 *group) {
+	Bits64 x = LoadGroup(group);
+	return x & ~(x << 6) & HIGHS;
+}
+
+#define GetMatchIndex(matches)     (BitScanForward(matches) / 8)
+#define GetLastMatchIndex(matches) (BitScanReverse(matches) / 8)
+
+#endif
+
+/******************************************************************************/
+
+U64 HashBytes(const void *bytes, Size size) {
+	const U8 *p = bytes;
+	U64 result = 0x9e3779b97f4a7c15 ^ size;
+	U64 w;
+	for (; size >= sizeof(w); size -= sizeof(w), p += sizeof(w)) {
+		Copy(&w, p, sizeof(w));
+		result = (result ^ w) * 0xbf58476d1ce4e5b9;
+		result ^= result >> 31;
+	}
+	if (size) {
+		w = 0;
+		Copy(&w, p, size);
+		result = (result ^ w) * 0xbf58476d1ce4e5b9;
+	}
+	result ^= result >> 29;
+	result *= 0x94d049bb133111eb;
+	result ^= result >> 32;
+	return result;
+}
+
+PRIVATE inline Size GaugeValueOffset(Table *context) {
+	return AlignForwards(context->keySize, 8);
+}
+
+PRIVATE inline Size GaugeSlotSize(Table *context) {
+	return AlignForwards(GaugeValueOffset(context) + context->valueSize, 8);
+}
+
+PRIVATE inline Size GaugeControlsSize(Size capacity) {
+	return AlignForwards(capacity + GROUP_WIDTH, 8);
+}
+
+PRIVATE inline Size GaugeArraysSize(Size capacity, Table *context) {
+	return GaugeControlsSize(capacity) + capacity * GaugeSlotSize(context);
+}
+
+PRIVATE inline Byte *GetSlot(Size index, Table *context) {
+	return context->slots + index * GaugeSlotSize(context);
+}
+
+/* NOTE(Emhyr): the first group is mirrored beyond the last slot, so that a
+group can be loaded from any slot */
+PRIVATE inline void SetControl(Size index, U8 control, Table *context) {
+	context->controls[index] = control;
+	if (index < GROUP_WIDTH) context->controls[context->capacity + index] = control;
+}
+
+/* NOTE(Emhyr): the groups are probed by triangular numbers, which visit every
+group since the capacity is a power of 2 */
+PRIVATE Size FindSlot(const void *key, U64 hash, Table *context) {
+	Size mask = context->capacity - 1;
+	Size position = (hash >> 7) & mask;
+	for (Size stride = GROUP_WIDTH;; position = (position + stride) & mask, stride += GROUP_WIDTH) {
+		const U8 *group = context->controls + position;
+		for (Bits64 matches = MatchGroup(hash & 0x7f, group); matches; matches &= matches - 1) {
+			Size index = (position + GetMatchIndex(matches)) & mask;
+			if (!Compare(GetSlot(index, context), key, context->keySize)) return index;
+		}
+		if (MatchEmpties(group)) return context->capacity;
+	}
+}
+
+PRIVATE Size FindVacantSlot(U64 hash, Table *context) {
+	Size mask = context->capacity - 1;
+	Size position = (hash >> 7) & mask;
+	for (Size stride = GROUP_WIDTH;; position = (position + stride) & mask, stride += GROUP_WIDTH) {
+		Bits64 matches = MatchVacancies(context->controls + position);
+		if (matches) return (position + GetMatchIndex(matches)) & mask;
+	}
+}
+
+PRIVATE Byte *AllocateTableArrays(Size capacity, Table *context) {
+	Size size = GaugeArraysSize(capacity, context);
+	if (context->granular) return Put(size, context->granular);
+	Assert(context->linear, "the table needs an allocator");
+	return Push(size, 16, context->linear);
+}
+
+PRIVATE void DeallocateTableArrays(Table *context) {
+	if (context->controls && context->granular)
+		Pop(context->controls, GaugeArraysSize(context->capacity, context), context->granular);
+}
+
+PRIVATE inline void SwapSlots(Byte *a, Byte *b, Size size) {
+	U64 *x = (U64 *)a;
+	U64 *y = (U64 *)b;
+	for (Size i = 0; i < size / sizeof(U64); ++i) {
+		U64 t = x[i];
+		x[i] = y[i];
+		y[i] = t;
+	}
+}
+
+/* NOTE(Emhyr): drops the deletions without new arrays. the full slots are
+marked deleted and the deleted ones empty, then each marked slot stays if it's
+within the first group that its probe can reach, or else it's moved to an empty
+slot, or swapped with another marked one that's placed next */
+PRIVATE void RehashTableInPlace(Table *context) {
+	Size mask = context->capacity - 1;
+	Size slotSize = GaugeSlotSize(context);
+	for (Size i = 0; i < context->capacity; ++i)
+		SetControl(i, context->controls[i] & 0x80 ? CONTROL_EMPTY : CONTROL_DELETED, context);
+	for (Size i = 0; i < context->capacity; ++i) {
+		if (context->controls[i] != CONTROL_DELETED) continue;
+		Byte *slot = GetSlot(i, context);
+		U64 hash = HashBytes(slot, context->keySize);
+		Size position = (hash >> 7) & mask;
+		Size index = FindVacantSlot(hash, context);
+		if (((index - position) & mask) / GROUP_WIDTH == ((i - position) & mask) / GROUP_WIDTH) {
+			SetControl(i, hash & 0x7f, context);
+			continue;
+		}
+		Byte *target = GetSlot(index, context);
+		if (context->controls[index] == CONTROL_EMPTY) {
+			Copy(target, slot, slotSize);
+			SetControl(i, CONTROL_EMPTY, context);
+		} else {
+			SwapSlots(target, slot, slotSize);
+			--i;
+		}
+		SetControl(index, hash & 0x7f, context);
+	}
+	context->deletions = 0;
+}
+
+PRIVATE void RehashTable(Size capacity, Table *context) {
+	if (capacity == context->capacity) {
+		RehashTableInPlace(context);
+		return;
+	}
+	Table old = *context;
+	Byte *arrays = AllocateTableArrays(capacity, context);
+	Assert(arrays, "overflowed! the table's allocator is exhausted");
+	context->capacity  = capacity;
+	context->count     = 0;
+	context->deletions = 0;
+	context->controls  = (U8 *)arrays;
+	context->slots     = arrays + GaugeControlsSize(capacity);
+	Fill(context->controls, CONTROL_EMPTY, capacity + GROUP_WIDTH);
+
+	Size slotSize = GaugeSlotSize(context);
+	for (Size i = 0; i < old.capacity; ++i) {
+		if (old.controls[i] & 0x80) continue;
+		Byte *slot = old.slots + i * slotSize;
+		U64 hash = HashBytes(slot, context->keySize);
+		Size index = FindVacantSlot(hash, context);
+		SetControl(index, hash & 0x7f, context);
+		Copy(GetSlot(index, context), slot, slotSize);
+		++context->count;
+	}
+	DeallocateTableArrays(&old);
+}
+
+/* NOTE(Emhyr): the load is kept within 7/8 of the capacity */
+PRIVATE inline Size GaugeTableCapacity(Size count) {
+	Size result = MINIMUM_TABLE_CAPACITY;
+	while (result - result / 8 < count) result *= 2;
+	return result;
+}
+
+/* table / creation ***********************************************************/
+
+void ReserveTable(Size count, Table *context) {
+	Size capacity = GaugeTableCapacity(count);
+	if (capacity > context->capacity) RehashTable(capacity, context);
+}
+
+/* table / destruction ********************************************************/
+
+void ClearTable(Table *context) {
+	if (!context->capacity) return;
+	Fill(context->controls, CONTROL_EMPTY, context->capacity + GROUP_WIDTH);
+	context->count = 0;
+	context->deletions = 0;
+}
+
+void ReleaseTable(Table *context) {
+	DeallocateTableArrays(context);
+	context->capacity  = 0;
+	context->count     = 0;
+	context->deletions = 0;
+	context->controls  = 0;
+	context->slots     = 0;
+}
+
+/* table / access *************************************************************/
+
+void *FindTableEntry(const void *key, Table *context) {
+	if (!context->capacity) return 0;
+	Size index = FindSlot(key, HashBytes(key, context->keySize), context);
+	if (index == context->capacity) return 0;
+	return GetSlot(index, context) + GaugeValueOffset(context);
+}
+
+/* NOTE(Emhyr): the table is rehashed in place if the deletions crowd it,
+otherwise it's doubled */
+void *InsertTableEntry(const void *key, Boolean *didExist, Table *context) {
+	U64 hash = HashBytes(key, context->keySize);
+	Size index = context->capacity ? FindSlot(key, hash, context) : 0;
+	if (didExist) *didExist = context->capacity && index != context->capacity;
+	if (context->capacity && index != context->capacity) return GetSlot(index, context) + GaugeValueOffset(context);
+
+	if (context->count + context->deletions + 1 > context->capacity - context->capacity / 8) {
+		Size capacity = GaugeTableCapacity(context->count + 1);
+		RehashTable(capacity > context->capacity ? capacity : context->capacity, context);
+	}
+	index = FindVacantSlot(hash, context);
+	if (context->controls[index] == CONTROL_DELETED) --context->deletions;
+	SetControl(index, hash & 0x7f, context);
+	++context->count;
+
+	Byte *slot = GetSlot(index, context);
+	Copy(slot, key, context->keySize);
+	Zero(slot + GaugeValueOffset(context), context->valueSize);
+	return slot + GaugeValueOffset(context);
+}
+
+/* NOTE(Emhyr): a slot can be emptied instead of deleted if no probe could've
+passed it, i.e. if no group that covers it was ever full. that's so when the
+vacancies around it are closer than a group's width. a table within a group is
+always covered by a probe's first group */
+PRIVATE inline Boolean CheckEmptiable(Size index, Table *context) {
+	if (context->capacity <= GROUP_WIDTH) return 1;
+	Bits64 emptiesBefore = MatchEmpties(context->controls + ((index - GROUP_WIDTH) & (context->capacity - 1)));
+	Bits64 emptiesAfter  = MatchEmpties(context->controls + index);
+	return emptiesBefore && emptiesAfter && GetMatchIndex(emptiesAfter) + GROUP_WIDTH - 1 - GetLastMatchIndex(emptiesBefore) < GROUP_WIDTH;
+}
+
+Boolean RemoveTableEntry(const void *key, Table *context) {
+	if (!context->capacity) return 0;
+	Size index = FindSlot(key, HashBytes(key, context->keySize), context);
+	if (index == context->capacity) return 0;
+	--context->count;
+	if (CheckEmptiable(index, context)) {
+		SetControl(index, CONTROL_EMPTY, context);
+		return 1;
+	}
+	SetControl(index, CONTROL_DELETED, context);
+	++context->deletions;
+	return 1;
+}
+
+Boolean IterateTable(Size *cursor, void **key, void **value, Table *context) {
+	for (Size i = *cursor; i < context->capacity; ++i) {
+		if (context->controls[i] & 0x80) continue;
+		*key = GetSlot(i, context);
+		*value = (Byte *)*key + GaugeValueOffset(context);
+		*cursor = i + 1;
+		return 1;
+	}
+	*cursor = context->capacity;
+	return 0;
+}
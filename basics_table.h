@@ -0,0 +1,71 @@
+/*
+an open-addressing hash table of fixed-size keys and values, after the swiss
+tables. each slot has a control byte: either empty, deleted, or the lowest 7
+bits of its key's hash. a group of control bytes is matched at once, by SSE2 on
+x64 or by SWAR elsewhere, so most lookups compare a single key.
+
+it's ZII-based, but it needs an allocator to take its storage from: a linear
+allocator, whose arrays are left behind when the table grows and are released
+in bulk by clearing the allocator, or a granular allocator, whose arrays are
+popped when the table grows or is released.
+
+the keys are hashed and compared by their bytes, so they shouldn't have padding.
+the slots are aligned by 8 bytes.
+
+	Table table = {.keySize = sizeof(U64), .valueSize = sizeof(U64), .linear = &arena};
+	U64 key = 7;
+	*(U64 *)InsertTableEntry(&key, 0, &table) = 49;
+	U64 *value = FindTableEntry(&key, &table);
+*/
+
+#if !defined(INCLUDED_BASICS_TABLE_H)
+#define INCLUDED_BASICS_TABLE_H
+
+#include "basics_memory.h"
+
+/******************************************************************************/
+/* settings */
+
+/* the least capacity of a table's first arrays */
+#if !defined(MINIMUM_TABLE_CAPACITY)
+#define MINIMUM_TABLE_CAPACITY 16
+#endif
+
+/******************************************************************************/
+
+typedef struct {
+	Size keySize;
+	Size valueSize;
+
+	LinearAllocator   *linear;
+	GranularAllocator *granular;
+
+	Size  capacity;
+	Size  count;
+	Size  deletions;
+	U8   *controls;
+	Byte *slots;
+} Table;
+
+PUBLIC U64 HashBytes(const void *bytes, Size size);
+
+/* table / creation ***********************************************************/
+PUBLIC void ReserveTable(Size count, Table *context);
+
+/* table / destruction ********************************************************/
+PUBLIC void ClearTable  (Table *context);
+PUBLIC void ReleaseTable(Table *context);
+
+/* table / access *************************************************************/
+
+/* NOTE(Emhyr): the values are returned by pointers, which remain valid until
+an insertion rehashes the table. `*didExist` may be null */
+PUBLIC void   *FindTableEntry  (const void *key, Table *context);
+PUBLIC void   *InsertTableEntry(const void *key, Boolean *didExist, Table *context);
+PUBLIC Boolean RemoveTableEntry(const void *key, Table *context);
+
+/* NOTE(Emhyr): iterates from `*cursor`, which begins at 0. returns whether
+there was another entry */
+PUBLIC Boolean IterateTable(Size *cursor, void **key, void **value, Table *context);
+
+#endif
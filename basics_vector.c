@@ -0,0 +1,49 @@
+#include "basics_vector.h"
+
+/******************************************************************************/
+/* auxiliaries */
+
+EXTERNAL void *CCALL memcpy(void *RESTRICT, const void *RESTRICT, unsigned long long);
+
+#define Copy(d, s, n) (void)memcpy(d, s, n)
+
+/* vector / allocation ********************************************************/
+
+/* NOTE(Emhyr): returns the elements, which never move. the commission grows
+geometrically, so appending is amortized O(1) */
+void *GrowVector(Size count, Size size, Vector *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (!allocator->address) InitializeLinearAllocator(allocator);
+	void *result = Push(count * size, 1, allocator);
+	Assert(result, "overflowed! the vector's reservation is too small");
+	context->count += count;
+	return (void *)allocator->address;
+}
+
+void *AppendVectorElements(const void *elements, Size count, Size size, Vector *context) {
+	Byte *result = GrowVector(count, size, context);
+	Copy(result + (context->count - count) * size, elements, count * size);
+	return result;
+}
+
+/* vector / deallocation ******************************************************/
+
+void ShrinkVector(Size count, Size size, Vector *context) {
+	Assert(count <= context->count, "underflowed!");
+	Pull(count * size, 1, &context->allocator);
+	context->count -= count;
+}
+
+void ShrinkVectorWaned(Size count, Size size, Vector *context) {
+	Assert(count <= context->count, "underflowed!");
+	if (!context->allocator.address) return;
+	PullWaned(count * size, 1, &context->allocator);
+	context->count -= count;
+}
+
+void ReleaseVector(Vector *context) {
+	LinearAllocator *allocator = &context->allocator;
+	if (allocator->address) ReleaseVirtualMemory(allocator->address, allocator->reservation);
+	*allocator = (LinearAllocator){0};
+	context->count = 0;
+}
@@ -0,0 +1,62 @@
+/*
+a growable array upon virtual memory that never moves. it reserves once and
+commits as it grows, so appending never copies, and pointers into it remain
+valid until it's shrunk past them.
+
+it's a linear allocator whose extent is its elements. the typed macros keep a
+pointer to the elements beside it:
+
+	typedef VECTOR(int) Integers;
+	Integers integers = {0};
+	AppendVector(&integers, 7);
+	int seven = PopVector(&integers);
+
+the elements' pointer is null until the first append. since the elements are
+aligned by a page, any type's alignment is satisfied.
+*/
+
+#if !defined(INCLUDED_BASICS_VECTOR_H)
+#define INCLUDED_BASICS_VECTOR_H
+
+#include "basics_memory.h"
+
+typedef struct {
+	LinearAllocator allocator;
+	Size            count;
+} Vector;
+
+/* vector / allocation ********************************************************/
+PUBLIC void *GrowVector          (Size count, Size size, Vector *context);
+PUBLIC void *AppendVectorElements(const void *elements, Size count, Size size, Vector *context);
+
+/* vector / deallocation ******************************************************/
+PUBLIC void ShrinkVector     (Size count, Size size, Vector *context);
+PUBLIC void ShrinkVectorWaned(Size count, Size size, Vector *context);
+PUBLIC void ReleaseVector    (Vector *context);
+
+/* vector / typed *************************************************************/
+
+#if defined(LANGUAGE_IS_CPP)
+#define ELEMENTSOF(v, p) static_cast<decltype((v)->elements)>(p)
+#else
+#define ELEMENTSOF(v, p) (p)
+#endif
+
+#define VECTOR(T) struct { Vector vector; T *elements; }
+
+#define ELEMENTSIZEOF(v) sizeof(*(v)->elements)
+
+/* NOTE(Emhyr): each evaluates to the appended element */
+#define AppendVector(v, x)          ((v)->elements = ELEMENTSOF(v, GrowVector(1, ELEMENTSIZEOF(v), &(v)->vector)), (v)->elements[(v)->vector.count - 1] = (x))
+#define AppendVectorUndefined(v, n) ((v)->elements = ELEMENTSOF(v, GrowVector((n), ELEMENTSIZEOF(v), &(v)->vector)), (v)->elements + (v)->vector.count - (n))
+#define AppendVectorArray(v, p, n)  ((v)->elements = ELEMENTSOF(v, AppendVectorElements((p), (n), ELEMENTSIZEOF(v), &(v)->vector)), (v)->elements + (v)->vector.count - (n))
+
+/* NOTE(Emhyr): the popped element remains readable until the next append */
+#define PopVector(v)                (ShrinkVector(1, ELEMENTSIZEOF(v), &(v)->vector), (v)->elements[(v)->vector.count])
+
+/* NOTE(Emhyr): shrinks to `n` elements, and decommits the pages beyond them */
+#define TruncateVector(v, n)        ShrinkVectorWaned((v)->vector.count - (n), ELEMENTSIZEOF(v), &(v)->vector)
+
+#define ClearVector(v)              TruncateVector(v, 0)
+
+#endif
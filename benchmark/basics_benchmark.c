@@ -0,0 +1,614 @@
+/*
+allocator micro-benchmarks.
+
+each benchmark times batches of operations and reports the nanoseconds per
+operation (the mean and percentiles across batches) and the page faults. the
+results are written as JSON to the given path, or to the standard output.
+
+	./build.sh release
+	build/basics_benchmark results.json
+*/
+
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "../basics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/******************************************************************************/
+/* settings */
+
+/* the amount of operations timed at once */
+#if !defined(BATCH_SIZE)
+#define BATCH_SIZE 256
+#endif
+
+/* the amount of batches timed per benchmark */
+#if !defined(BATCHES_COUNT)
+#define BATCHES_COUNT 2000
+#endif
+
+/* the quantity of the pools used by the granular benchmarks */
+#if !defined(POOL_QUANTITY)
+#define POOL_QUANTITY 0x40000
+#endif
+
+/******************************************************************************/
+
+typedef struct {
+	F64 samples[BATCHES_COUNT];
+	Size count;
+	U64 beginning;
+	U64 faults[2];
+} Measurement;
+
+PRIVATE FILE *output;
+PRIVATE Size benchmarksCount;
+PRIVATE Measurement measurement;
+
+PRIVATE U64 QueryNanoseconds(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (U64)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+PRIVATE void QueryFaults(U64 faults[2]) {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	faults[0] = usage.ru_minflt;
+	faults[1] = usage.ru_majflt;
+}
+
+PRIVATE void BeginMeasurement(void) {
+	measurement.count = 0;
+	QueryFaults(measurement.faults);
+}
+
+PRIVATE inline void BeginBatch(void) {
+	measurement.beginning = QueryNanoseconds();
+}
+
+PRIVATE inline void EndBatch(Size operations) {
+	U64 ending = QueryNanoseconds();
+	if (measurement.count < BATCHES_COUNT)
+		measurement.samples[measurement.count++] = (F64)(ending - measurement.beginning) / operations;
+}
+
+PRIVATE int CompareSamples(const void *a, const void *b) {
+	F64 x = *(const F64 *)a, y = *(const F64 *)b;
+	return (x > y) - (x < y);
+}
+
+PRIVATE F64 GetPercentile(F64 percentile) {
+	Size i = (Size)(percentile * (measurement.count - 1) + 0.5);
+	return measurement.samples[i];
+}
+
+/* NOTE(Emhyr): `parameters` is a JSON object's members, e.g. "\"size\": 64",
+and so is `results`, which are appended to the measured ones */
+PRIVATE void EndMeasurementWith(const char *name, const char *parameters, const char *results) {
+	U64 faults[2];
+	QueryFaults(faults);
+	F64 mean = 0;
+	for (Size i = 0; i < measurement.count; ++i) mean += measurement.samples[i];
+	mean /= measurement.count;
+	qsort(measurement.samples, measurement.count, sizeof(F64), CompareSamples);
+
+	fprintf(output, "%s\n\t\t{\"name\": \"%s\", \"parameters\": {%s}, \"operations\": %llu, ", benchmarksCount ? "," : "", name, parameters, (U64)measurement.count * BATCH_SIZE);
+	fprintf(output, "\"nanosecondsPerOperation\": {\"mean\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"maximum\": %.3f}, ", mean, GetPercentile(0.50), GetPercentile(0.90), GetPercentile(0.99), measurement.samples[measurement.count - 1]);
+	fprintf(output, "\"minorFaults\": %llu, \"majorFaults\": %llu", faults[0] - measurement.faults[0], faults[1] - measurement.faults[1]);
+	fprintf(output, "%s%s}", results ? ", " : "", results ? results : "");
+	fflush(output);
+	++benchmarksCount;
+}
+
+PRIVATE void EndMeasurement(const char *name, const char *parameters) {
+	EndMeasurementWith(name, parameters, 0);
+}
+
+/* NOTE(Emhyr): the batches of operations that are interleaved with the measured
+ones are measured aside. their faults are counted in `aside` instead of the
+measurement, and `faults` holds those at the batch's beginning */
+
+PRIVATE inline void BeginAsideBatch(U64 faults[2], Measurement *aside) {
+	QueryFaults(faults);
+	aside->beginning = QueryNanoseconds();
+}
+
+PRIVATE inline void EndAsideBatch(Size operations, U64 faults[2], Measurement *aside) {
+	U64 ending = QueryNanoseconds();
+	U64 endingFaults[2];
+	QueryFaults(endingFaults);
+	if (aside->count < BATCHES_COUNT)
+		aside->samples[aside->count++] = (F64)(ending - aside->beginning) / operations;
+	for (Size i = 0; i < 2; ++i) {
+		aside->faults[i] += endingFaults[i] - faults[i];
+		measurement.faults[i] += endingFaults[i] - faults[i];
+	}
+}
+
+PRIVATE void EndAsideMeasurement(const char *name, const char *parameters, Measurement *aside) {
+	memcpy(measurement.samples, aside->samples, sizeof(aside->samples));
+	measurement.count = aside->count;
+	QueryFaults(measurement.faults);
+	for (Size i = 0; i < 2; ++i) measurement.faults[i] -= aside->faults[i];
+	EndMeasurement(name, parameters);
+}
+
+PRIVATE U64 randomState = 0x9e3779b97f4a7c15;
+
+PRIVATE inline U64 Random(void) {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+/* NOTE(Emhyr): keeps the compiler from discarding the benchmarked results */
+PRIVATE void *volatile sink;
+
+/* linear allocator ***********************************************************/
+
+PRIVATE void BenchmarkPush(Size size) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"size\": %llu", size);
+
+	LinearAllocator allocator = {0};
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = Push(size, 8, &allocator);
+		EndBatch(BATCH_SIZE);
+		ClearLinearAllocator(&allocator);
+	}
+	EndMeasurement("Push", parameters);
+	ReleaseVirtualMemory(allocator.address, allocator.reservation);
+}
+
+PRIVATE void BenchmarkFrames(Size size) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"size\": %llu", size);
+
+	LinearAllocator allocator = {0};
+	void *frames[BATCH_SIZE];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) frames[j] = PushFrame(size, 8, &allocator);
+		EndBatch(BATCH_SIZE);
+		for (Size j = BATCH_SIZE; j--;) PullFrame(frames[j], &allocator);
+	}
+	EndMeasurement("PushFrame", parameters);
+
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) frames[j] = PushFrame(size, 8, &allocator);
+		BeginBatch();
+		for (Size j = BATCH_SIZE; j--;) PullFrame(frames[j], &allocator);
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("PullFrame", parameters);
+	ReleaseVirtualMemory(allocator.address, allocator.reservation);
+}
+
+/* granular allocator *********************************************************/
+
+/* NOTE(Emhyr): the pool is filled completely, then randomly emptied down to the
+fill ratio, so that the vacancies are scattered */
+PRIVATE void FillPool(F64 ratio, GranularAllocator *allocator) {
+	Size quantity = allocator->quantity;
+	void **blocks = malloc(quantity * sizeof(void *));
+	for (Size i = 0; i < quantity; ++i) blocks[i] = Put(allocator->granularity, allocator);
+	for (Size i = quantity; i > 1; --i) {
+		Size j = Random() % i;
+		void *t = blocks[i - 1];
+		blocks[i - 1] = blocks[j];
+		blocks[j] = t;
+	}
+	Size vacancies = (Size)((1 - ratio) * quantity);
+	for (Size i = 0; i < vacancies; ++i) Pop(blocks[i], allocator->granularity, allocator);
+	free(blocks);
+}
+
+PRIVATE void BenchmarkPutPop(Size granularity, F64 ratio) {
+	char parameters[96];
+	snprintf(parameters, sizeof(parameters), "\"granularity\": %llu, \"fill\": %.2f", granularity, ratio);
+
+	GranularAllocator allocator = {.reservation = AlignForwards(POOL_QUANTITY * (granularity + 1), 0x200000) + 0x200000, .granularity = granularity, .quantity = POOL_QUANTITY, .capacity = POOL_QUANTITY};
+	InitializeGranularAllocator(&allocator);
+	FillPool(ratio, &allocator);
+
+	void *blocks[BATCH_SIZE];
+	PERSISTANT Measurement pops;
+	pops = (Measurement){0};
+	U64 faults[2];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) blocks[j] = Put(granularity, &allocator);
+		EndBatch(BATCH_SIZE);
+
+		BeginAsideBatch(faults, &pops);
+		for (Size j = 0; j < BATCH_SIZE; ++j) if (blocks[j]) Pop(blocks[j], granularity, &allocator);
+		EndAsideBatch(BATCH_SIZE, faults, &pops);
+	}
+	EndMeasurement("Put", parameters);
+	EndAsideMeasurement("Pop", parameters, &pops);
+	ReleaseVirtualMemory(allocator.address, allocator.reservation);
+}
+
+/* NOTE(Emhyr): the pool is kept about three quarters full by replacing random
+blocks with blocks of random sizes, mostly small and sometimes up to
+`CHURN_LARGEST` granules. only the puts are timed. the fragmentation is one
+minus the largest clear run over all the clear granules, once churned */
+
+#define CHURN_BLOCKS  (POOL_QUANTITY / 8)
+#define CHURN_LARGEST 32
+
+typedef struct {
+	Byte *address;
+	Size  count;
+} ChurnedBlock;
+
+PRIVATE inline Size GaugeChurnedCount(void) {
+	return Random() % 4 ? 1 + Random() % 4 : 1 + Random() % CHURN_LARGEST;
+}
+
+PRIVATE int CompareChurnedBlocks(const void *a, const void *b) {
+	Byte *x = ((const ChurnedBlock *)a)->address, *y = ((const ChurnedBlock *)b)->address;
+	return (x > y) - (x < y);
+}
+
+PRIVATE F64 GaugeFragmentation(ChurnedBlock *blocks, Size count, GranularAllocator *allocator) {
+	qsort(blocks, count, sizeof(ChurnedBlock), CompareChurnedBlocks);
+	Size clear = 0, largest = 0, index = 0;
+	for (Size i = 0; i <= count; ++i) {
+		Size next = allocator->quantity;
+		if (i < count) {
+			if (!blocks[i].address) continue;
+			next = (blocks[i].address - (Byte *)allocator->address) / allocator->granularity;
+		}
+		Size run = next - index;
+		clear += run;
+		if (run > largest) largest = run;
+		if (i < count) index = next + blocks[i].count;
+	}
+	return clear ? 1 - (F64)largest / clear : 0;
+}
+
+PRIVATE void BenchmarkPlacement(Size placement) {
+	PERSISTANT const char *names[] = {"first-fit", "next-fit", "best-fit"};
+	char parameters[96];
+	snprintf(parameters, sizeof(parameters), "\"placement\": \"%s\", \"granularity\": 16", names[placement]);
+
+	GranularAllocator allocator = {.granularity = 16, .quantity = POOL_QUANTITY, .capacity = POOL_QUANTITY, .placement = placement};
+	InitializeGranularAllocator(&allocator);
+	PERSISTANT ChurnedBlock blocks[CHURN_BLOCKS];
+	for (Size i = 0; i < CHURN_BLOCKS; ++i) {
+		blocks[i].count = GaugeChurnedCount();
+		blocks[i].address = Put(blocks[i].count * 16, &allocator);
+	}
+
+	Size failures = 0;
+	Size victims[BATCH_SIZE];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			ChurnedBlock *block = &blocks[victims[j] = Random() % CHURN_BLOCKS];
+			if (block->address) Pop(block->address, block->count * 16, &allocator);
+			block->address = 0;
+			block->count = GaugeChurnedCount();
+		}
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			ChurnedBlock *block = &blocks[victims[j]];
+			if (!block->address) block->address = Put(block->count * 16, &allocator);
+		}
+		EndBatch(BATCH_SIZE);
+		for (Size j = 0; j < BATCH_SIZE; ++j) failures += !blocks[victims[j]].address;
+	}
+
+	char results[96];
+	snprintf(results, sizeof(results), "\"failures\": %llu, \"fragmentation\": %.4f", failures, GaugeFragmentation(blocks, CHURN_BLOCKS, &allocator));
+	EndMeasurementWith("Put (churn)", parameters, results);
+	ReleaseVirtualMemory(allocator.address, allocator.reservation);
+}
+
+PRIVATE void BenchmarkMallocFree(Size size) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"size\": %llu", size);
+
+	void *blocks[BATCH_SIZE];
+	PERSISTANT Measurement frees;
+	frees = (Measurement){0};
+	U64 faults[2];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) blocks[j] = malloc(size);
+		EndBatch(BATCH_SIZE);
+
+		BeginAsideBatch(faults, &frees);
+		for (Size j = 0; j < BATCH_SIZE; ++j) free(blocks[j]);
+		EndAsideBatch(BATCH_SIZE, faults, &frees);
+	}
+	EndMeasurement("malloc", parameters);
+	EndAsideMeasurement("free", parameters, &frees);
+}
+
+/* table **********************************************************************/
+
+/* NOTE(Emhyr): the keys are random, and the lookups hit as often as `ratio`.
+`count` shouldn't exceed `BATCHES_COUNT` batches */
+PRIVATE void BenchmarkTable(Size count, F64 ratio) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"count\": %llu, \"hits\": %.2f", count, ratio);
+
+	LinearAllocator arena = {0};
+	Table table = {.keySize = sizeof(U64), .valueSize = sizeof(U64), .linear = &arena};
+	U64 *keys = malloc(count * sizeof(U64));
+	BeginMeasurement();
+	for (Size i = 0; i < count; i += BATCH_SIZE) {
+		Size n = count - i < BATCH_SIZE ? count - i : BATCH_SIZE;
+		for (Size j = 0; j < n; ++j) keys[i + j] = Random();
+		BeginBatch();
+		for (Size j = 0; j < n; ++j) *(U64 *)InsertTableEntry(&keys[i + j], 0, &table) = j;
+		EndBatch(n);
+	}
+	EndMeasurement("InsertTableEntry", parameters);
+
+	U64 lookups[BATCH_SIZE];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) lookups[j] = (F64)(Random() % 1000) < ratio * 1000 ? keys[Random() % count] : Random();
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = FindTableEntry(&lookups[j], &table);
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("FindTableEntry", parameters);
+	free(keys);
+	ReleaseVirtualMemory(arena.address, arena.reservation);
+}
+
+/* NOTE(Emhyr): random insertions, lookups and removals among `range` keys of
+`words` words, which are checked against a model of the table, so that the
+deletions and rehashes are exercised. a mismatch traps */
+PRIVATE void BenchmarkTableChurn(Size range, Size words) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"keys\": %llu, \"keySize\": %llu", range, words * sizeof(U64));
+
+	LinearAllocator arena = {0};
+	Table table = {.keySize = words * sizeof(U64), .valueSize = sizeof(U64), .linear = &arena};
+	U64 *model = calloc(range, sizeof(U64));
+	U64 keys[BATCH_SIZE][4];
+	U8 operations[BATCH_SIZE];
+	U64 outcomes[BATCH_SIZE];
+	Size extent = 0;
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			keys[j][0] = Random() % range;
+			for (Size k = 1; k < words; ++k) keys[j][k] = keys[j][0] * k;
+			operations[j] = Random() % 3;
+		}
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			if (operations[j] == 0) {
+				Boolean didExist;
+				U64 *value = InsertTableEntry(keys[j], &didExist, &table);
+				*value = i * BATCH_SIZE + j + 1;
+				outcomes[j] = didExist;
+			} else if (operations[j] == 1) {
+				U64 *value = FindTableEntry(keys[j], &table);
+				outcomes[j] = value ? *value : 0;
+			} else outcomes[j] = RemoveTableEntry(keys[j], &table);
+		}
+		EndBatch(BATCH_SIZE);
+
+		/* NOTE(Emhyr): a model's entry is the value of the key's entry, or 0 */
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			U64 *entry = &model[keys[j][0]];
+			if (operations[j] == 0) {
+				Assert(outcomes[j] == !!*entry, "mismatched insertion");
+				*entry = i * BATCH_SIZE + j + 1;
+			} else if (operations[j] == 1) Assert(outcomes[j] == *entry, "mismatched lookup");
+			else {
+				Assert(outcomes[j] == !!*entry, "mismatched removal");
+				*entry = 0;
+			}
+		}
+		if (i == BATCHES_COUNT / 2) extent = arena.extent;
+	}
+
+	Size count = 0;
+	for (Size i = 0; i < range; ++i) count += !!model[i];
+	Assert(table.count == count, "mismatched count");
+	Size cursor = 0;
+	void *key, *value;
+	while (IterateTable(&cursor, &key, &value, &table)) {
+		Assert(model[*(U64 *)key] == *(U64 *)value, "mismatched iteration");
+		--count;
+	}
+	Assert(!count, "mismatched iteration");
+
+	char results[96];
+	snprintf(results, sizeof(results), "\"capacity\": %llu, \"extentGrowth\": %llu", table.capacity, arena.extent - extent);
+	EndMeasurementWith("Table (churn)", parameters, results);
+	free(model);
+	ReleaseVirtualMemory(arena.address, arena.reservation);
+}
+
+/* bits ***********************************************************************/
+
+#define BITS_COUNT 4096
+
+/* NOTE(Emhyr): every bit is set besides one run of `n` clear bits near the
+end, so each search scans nearly all the words */
+PRIVATE void BenchmarkFindBits(Size n) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"n\": %llu, \"words\": %d", n, BITS_COUNT);
+
+	PERSISTANT Bits64 bits[BITS_COUNT];
+	memset(bits, 0xff, sizeof(bits));
+	Size beginning = (BITS_COUNT - 8) * WIDTHOF(Bits64) - n / 2;
+	SetBits(n, (BitLocation){bits + beginning / WIDTHOF(Bits64), beginning % WIDTHOF(Bits64)}, 1, 0);
+
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT / 8; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = FindBits(n, bits, bits + BITS_COUNT, 1).pointer;
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("FindBits", parameters);
+}
+
+PRIVATE void BenchmarkSetBits(Size n) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"n\": %llu", n);
+
+	PERSISTANT Bits64 bits[BITS_COUNT];
+	Size limit = BITS_COUNT * WIDTHOF(Bits64) - n;
+	Size beginnings[BATCH_SIZE];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) beginnings[j] = Random() % (limit + 1);
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			Size k = beginnings[j];
+			SetBits(n, (BitLocation){bits + k / WIDTHOF(Bits64), k % WIDTHOF(Bits64)}, j & 1, 0);
+		}
+		EndBatch(BATCH_SIZE);
+	}
+	sink = bits;
+	EndMeasurement("SetBits", parameters);
+}
+
+PRIVATE void BenchmarkCountBits(Size n) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"words\": %llu", n);
+
+	PERSISTANT Bits64 bits[BITS_COUNT];
+	for (Size i = 0; i < BITS_COUNT; ++i) bits[i] = Random();
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT / 8; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = (void *)CountBits(bits, bits + n);
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("CountBits", parameters);
+}
+
+PRIVATE void BenchmarkRankBits(void) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"words\": %d", BITS_COUNT);
+
+	PERSISTANT Bits64 bits[BITS_COUNT];
+	PERSISTANT Size memory[BITS_COUNT];
+	for (Size i = 0; i < BITS_COUNT; ++i) bits[i] = Random();
+	Assert(GaugeBitIndexSize(BITS_COUNT) <= sizeof(memory));
+	BitIndex index;
+	IndexBits(bits, bits + BITS_COUNT, memory, &index);
+
+	Size indices[BATCH_SIZE];
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) indices[j] = Random() % (BITS_COUNT * WIDTHOF(Bits64));
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = (void *)RankBits(indices[j], &index);
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("RankBits", parameters);
+
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT; ++i) {
+		for (Size j = 0; j < BATCH_SIZE; ++j) indices[j] = Random() % index.total;
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) sink = (void *)SelectBit(indices[j], &index);
+		EndBatch(BATCH_SIZE);
+	}
+	EndMeasurement("SelectBit", parameters);
+}
+
+/* NOTE(Emhyr): each word has about `density` of its bits set */
+PRIVATE void BenchmarkIterateBits(F64 density) {
+	char parameters[64];
+	snprintf(parameters, sizeof(parameters), "\"density\": %.2f, \"words\": %d", density, BITS_COUNT);
+
+	PERSISTANT Bits64 bits[BITS_COUNT];
+	PERSISTANT Size indices[BITS_COUNT * WIDTHOF(Bits64)];
+	memset(bits, 0, sizeof(bits));
+	for (Size i = 0; i < BITS_COUNT * WIDTHOF(Bits64); ++i)
+		if (Random() % 1000 < density * 1000) bits[i / WIDTHOF(Bits64)] |= (Bits64)1 << i % WIDTHOF(Bits64);
+
+	BeginMeasurement();
+	for (Size i = 0; i < BATCHES_COUNT / 64; ++i) {
+		BeginBatch();
+		for (Size j = 0; j < BATCH_SIZE; ++j) {
+			BitIterator iterator;
+			BeginBitIteration(bits, bits + BITS_COUNT, &iterator);
+			while (IterateBits(COUNTOF(indices), indices, &iterator));
+		}
+		EndBatch(BATCH_SIZE);
+	}
+	sink = indices;
+	EndMeasurement("IterateBits", parameters);
+}
+
+/******************************************************************************/
+
+int main(int argc, char **argv) {
+	output = stdout;
+	if (argc > 1) {
+		output = fopen(argv[1], "w");
+		if (!output) {
+			fprintf(stderr, "couldn't open \"%s\"\n", argv[1]);
+			return 1;
+		}
+	}
+
+	fprintf(output, "{\n\t\"batchSize\": %d,\n\t\"benchmarks\": [", BATCH_SIZE);
+
+	PERSISTANT const Size sizes[] = {16, 64, 256, 4096};
+	for (Size i = 0; i < COUNTOF(sizes); ++i) BenchmarkPush(sizes[i]);
+	for (Size i = 0; i < COUNTOF(sizes); ++i) BenchmarkFrames(sizes[i]);
+
+	PERSISTANT const Size granularities[] = {16, 64, 256};
+	PERSISTANT const F64 ratios[] = {0, 0.5, 0.9, 0.99};
+	for (Size i = 0; i < COUNTOF(granularities); ++i)
+		for (Size j = 0; j < COUNTOF(ratios); ++j)
+			BenchmarkPutPop(granularities[i], ratios[j]);
+	PERSISTANT const Size placements[] = {PLACEMENT_FIRST_FIT, PLACEMENT_NEXT_FIT, PLACEMENT_BEST_FIT};
+	for (Size i = 0; i < COUNTOF(placements); ++i) BenchmarkPlacement(placements[i]);
+	for (Size i = 0; i < COUNTOF(sizes); ++i) BenchmarkMallocFree(sizes[i]);
+
+	PERSISTANT const Size counts[] = {1000, 100000, 500000};
+	for (Size i = 0; i < COUNTOF(counts); ++i) {
+		BenchmarkTable(counts[i], 1);
+		BenchmarkTable(counts[i], 0);
+	}
+	PERSISTANT const Size churnedKeys[] = {100, 100000};
+	for (Size i = 0; i < COUNTOF(churnedKeys); ++i) {
+		BenchmarkTableChurn(churnedKeys[i], 1);
+		BenchmarkTableChurn(churnedKeys[i], 3);
+	}
+
+	PERSISTANT const Size runs[] = {1, 8, 64, 256, 1024};
+	for (Size i = 0; i < COUNTOF(runs); ++i) BenchmarkFindBits(runs[i]);
+	PERSISTANT const Size spans[] = {1, 7, 64, 200, 4096};
+	for (Size i = 0; i < COUNTOF(spans); ++i) BenchmarkSetBits(spans[i]);
+	PERSISTANT const Size lengths[] = {8, 256, BITS_COUNT};
+	for (Size i = 0; i < COUNTOF(lengths); ++i) BenchmarkCountBits(lengths[i]);
+	BenchmarkRankBits();
+	PERSISTANT const F64 densities[] = {0.01, 0.1, 0.5, 0.9};
+	for (Size i = 0; i < COUNTOF(densities); ++i) BenchmarkIterateBits(densities[i]);
+
+	fprintf(output, "\n\t]\n}\n");
+	if (output != stdout) fclose(output);
+	return 0;
+}
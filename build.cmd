@@ -15,7 +15,7 @@ set MODE=debug
 if "%1" == "release" set MODE=release
 
 rem set compiler flags
-set CFLAGS=/std:c11 /nologo /Oi /MP /GF /utf-8 /Z7 /arch:AVX512
+set CFLAGS=/std:c11 /nologo /Oi /MP /GF /utf-8 /Z7
 if "%MODE%" equ "debug" (
 	set CFLAGS=%CFLAGS% /Od /MDd
 ) else if "%MODE%" equ "release" (
@@ -0,0 +1,21 @@
+#!/bin/sh
+set -e
+cd "$(dirname "$0")"
+
+# parse commandline
+MODE=debug
+if [ "$1" = "release" ]; then MODE=release; fi
+
+# set compiler flags
+CC=${CC:-cc}
+CFLAGS="-std=c11 -g -pthread -Wno-unknown-warning-option -Wno-attributes -Wno-builtin-declaration-mismatch"
+if [ "$MODE" = "debug" ]; then
+	CFLAGS="$CFLAGS -O0"
+elif [ "$MODE" = "release" ]; then
+	CFLAGS="$CFLAGS -O2"
+fi
+
+mkdir -p build
+$CC $CFLAGS -o build/basics *.c
+$CC $CFLAGS -o build/basics_benchmark benchmark/basics_benchmark.c basics_memory.c basics_bits.c basics_table.c
+$CC $CFLAGS -fPIC -shared -ftls-model=initial-exec -Wl,--version-script=preload/basics_preload.map -o build/basics_preload.so preload/basics_preload.c basics_memory.c basics_bits.c
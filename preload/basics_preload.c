@@ -0,0 +1,116 @@
+/*
+an LD_PRELOAD-able `malloc` family upon a `SegregatedAllocator`.
+
+	./build.sh release
+	LD_PRELOAD=build/basics_preload.so program
+
+the version script hides every symbol besides the `malloc` family, so that the
+basics' procedures don't interpose the program's.
+*/
+
+#include "../basics.h"
+
+/* NOTE(Emhyr): the `malloc` family is declared with `size_t` here, unlike the
+rest of the basics, to agree with the system's declarations */
+
+#if defined(SYSTEM_IS_UNIX)
+
+#include <errno.h>
+#include <pthread.h>
+#include <stddef.h>
+
+PRIVATE SegregatedAllocator heap;
+
+/* NOTE(Emhyr): each thread's magazines are flushed by the key's destructor
+upon exiting. threads that only free fill them too, so they register as well.
+the destructor unregisters, so that the allocations of later destructors are
+flushed by another round of them */
+
+PRIVATE pthread_key_t flusher;
+PRIVATE pthread_once_t flusherOnce = PTHREAD_ONCE_INIT;
+PRIVATE THREADIC Boolean registered;
+
+PRIVATE void Flush(void *value) {
+	(void)value;
+	registered = 0;
+	FlushSegregatedCaches(&heap);
+}
+
+PRIVATE void CreateFlusher(void) {
+	pthread_key_create(&flusher, Flush);
+}
+
+PRIVATE inline void Register(void) {
+	if (registered) return;
+	registered = 1;
+	pthread_once(&flusherOnce, CreateFlusher);
+	pthread_setspecific(flusher, &registered);
+}
+
+/* NOTE(Emhyr): the family sets `errno` upon failing, as the system's does */
+PRIVATE inline void *Confirm(void *result) {
+	if (!result) errno = ENOMEM;
+	return result;
+}
+
+PUBLIC void *malloc(size_t size) {
+	Register();
+	return Confirm(Allocate(size, 0, &heap));
+}
+
+PUBLIC void free(void *address) {
+	if (!address) return;
+	Register();
+	Deallocate(address, &heap);
+}
+
+PUBLIC void *calloc(size_t count, size_t size) {
+	size_t total = count * size;
+	if (size && total / size != count) return Confirm(0);
+	Register();
+	return Confirm(AllocateZeroed(total, 0, &heap));
+}
+
+PUBLIC void *realloc(void *address, size_t size) {
+	if (address && !size) {
+		free(address);
+		return 0;
+	}
+	Register();
+	return Confirm(Reallocate(address, size, 0, &heap));
+}
+
+PUBLIC int posix_memalign(void **result, size_t alignment, size_t size) {
+	if (!CheckAlignment(alignment) || alignment % sizeof(void *)) return EINVAL;
+	Register();
+	*result = Allocate(size, alignment, &heap);
+	return *result ? 0 : ENOMEM;
+}
+
+PUBLIC void *aligned_alloc(size_t alignment, size_t size) {
+	if (!CheckAlignment(alignment)) {
+		errno = EINVAL;
+		return 0;
+	}
+	Register();
+	return Confirm(Allocate(size, alignment, &heap));
+}
+
+PUBLIC void *memalign(size_t alignment, size_t size) {
+	return aligned_alloc(alignment, size);
+}
+
+PUBLIC void *valloc(size_t size) {
+	return aligned_alloc(QueryVirtualMemoryGranularity(), size);
+}
+
+PUBLIC void *pvalloc(size_t size) {
+	Size pageSize = QueryVirtualMemoryGranularity();
+	return aligned_alloc(pageSize, AlignForwards(size, pageSize));
+}
+
+PUBLIC size_t malloc_usable_size(void *address) {
+	return GaugeAllocation(address, &heap);
+}
+
+#endif